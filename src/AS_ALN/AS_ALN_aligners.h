@@ -140,6 +140,10 @@ AS_ALN_Aligner     Optimal_Overlap_AS_forCNS;
 
 AS_ALN_OverlapScorer ScoreOverlap;
 
+//  DP_Compare() keeps its working storage per-thread.  Threads other than
+//  the main one should call this before exiting, or the storage leaks.
+void DP_Compare_freeScratch(void);
+
 #include "CA_ALN_local.h"
 int *AS_Local_Trace(Local_Overlap *local_overlap, char *aseq, char *bseq);
 
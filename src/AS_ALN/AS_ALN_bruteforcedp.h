@@ -51,4 +51,10 @@ alignLinker(char           *alignA,
             int             allowNs,
             int             ahang, int bhang);
 
+int
+alignLinkerScore(const char     *stringA,
+                 const char     *stringB,
+                 int             lenB,
+                 int             enough);
+
 #endif  //  AS_ALN_BRUTEFORCEDP
@@ -74,17 +74,26 @@ BestOverlapGraph::BestOverlapGraph(FragmentInfo        *fi,
                                    OverlapStore        *ovlStoreUniq,
                                    OverlapStore        *ovlStoreRept,
                                    double               AS_UTG_ERROR_RATE,
-                                   double               AS_UTG_ERROR_LIMIT) {
-  OVSoverlap olap;
-
+                                   double               AS_UTG_ERROR_LIMIT,
+                                   bool                 useRepeatFlags) {
   _fi = fi;
 
+  _useRepeatFlags = useRepeatFlags;
+
   _best_overlaps = new BestFragmentOverlap [fi->numFragments() + 1];
   _best_contains = new BestContainment     [fi->numFragments() + 1];
 
   memset(_best_overlaps, 0, sizeof(BestFragmentOverlap) * (fi->numFragments() + 1));
   memset(_best_contains, 0, sizeof(BestContainment)     * (fi->numFragments() + 1));
 
+  _best_contains_olapsBgn = new uint64 [fi->numFragments() + 2];
+  _best_contains_olaps    = NULL;
+
+  memset(_best_contains_olapsBgn, 0, sizeof(uint64) * (fi->numFragments() + 2));
+
+  _best_overlaps_score    = NULL;
+  _best_contains_score    = NULL;
+
   assert(AS_UTG_ERROR_RATE >= 0.0);
   assert(AS_UTG_ERROR_RATE <= AS_MAX_ERROR_RATE);
 
@@ -111,15 +120,8 @@ BestOverlapGraph::BestOverlapGraph(FragmentInfo        *fi,
   _best_contains_score    = new uint64 [fi->numFragments() + 1];
   memset(_best_contains_score,    0, sizeof(uint64) * (fi->numFragments() + 1));
 
-  AS_OVS_resetRangeOverlapStore(ovlStoreUniq);
-  while  (AS_OVS_readOverlapFromStore(ovlStoreUniq, &olap, AS_OVS_TYPE_OVL))
-    scoreContainment(olap);
-
-  if (ovlStoreRept) {
-    AS_OVS_resetRangeOverlapStore(ovlStoreRept);
-    while  (AS_OVS_readOverlapFromStore(ovlStoreRept, &olap, AS_OVS_TYPE_OVL))
-      scoreContainment(olap);
-  }
+  scoreOverlaps(ovlStoreUniq, true);
+  scoreOverlaps(ovlStoreRept, true);
 
   delete [] _best_contains_score;
   _best_contains_score    = NULL;
@@ -130,53 +132,47 @@ BestOverlapGraph::BestOverlapGraph(FragmentInfo        *fi,
     uint64  numContainsToSave = 0;
 
     for (uint32 i=0; i<fi->numFragments(); i++)
-      numContainsToSave += _best_contains[i].olapsLen;
+      numContainsToSave += _best_contains_olapsBgn[i];
 
     fprintf(stderr, "Need to save " F_U64" near-containment overlaps\n", numContainsToSave);
   }
 
+  allocateContainOlaps();
+
 
   //  Pass 2 through overlaps -- find dovetails, build the overlap graph.  For each
   //  contained fragment, remember some of the almost containment overlaps.
 
   //setLogFile("unitigger", "bestoverlapgraph-dovetails");
 
-  _best_overlaps_5p_score = new uint64 [fi->numFragments() + 1];
-  _best_overlaps_3p_score = new uint64 [fi->numFragments() + 1];
-
-  memset(_best_overlaps_5p_score, 0, sizeof(uint64) * (fi->numFragments() + 1));
-  memset(_best_overlaps_3p_score, 0, sizeof(uint64) * (fi->numFragments() + 1));
-
-  AS_OVS_resetRangeOverlapStore(ovlStoreUniq);
-  while  (AS_OVS_readOverlapFromStore(ovlStoreUniq, &olap, AS_OVS_TYPE_OVL))
-    scoreEdge(olap);
+  _best_overlaps_score    = new uint64 [2 * fi->numFragments() + 2];
+  memset(_best_overlaps_score,    0, sizeof(uint64) * (2 * fi->numFragments() + 2));
 
-  if (ovlStoreRept) {
-    AS_OVS_resetRangeOverlapStore(ovlStoreRept);
-    while  (AS_OVS_readOverlapFromStore(ovlStoreRept, &olap, AS_OVS_TYPE_OVL))
-      scoreEdge(olap);
-  }
-
-  delete [] _best_overlaps_5p_score;
-  delete [] _best_overlaps_3p_score;
+  scoreOverlaps(ovlStoreUniq, false);
+  scoreOverlaps(ovlStoreRept, false);
 
-  _best_overlaps_5p_score = NULL;
-  _best_overlaps_3p_score = NULL;
+  delete [] _best_overlaps_score;
+  _best_overlaps_score    = NULL;
 
   //setLogFile("unitigger", NULL);
 
 
-  //  Clean up our allocation.  We seem to over count the number of overlaps in the first pass,
-  //  then don't add any overlaps in the second pass, leaving the count positive and the pointer
-  //  NULL.  In the case where we just overcount, the pointer is valid, and the count is correct.
+  //  Pass 2 left each begin pointing at the end of its list, which is
+  //  the begin of the next list.  Shift them back into place.  Then sort
+  //  the lists long enough that containHaveEdgeTo() binary searches
+  //  them, so it never needs to modify anything.
   //
-  //  A better explanation is that we count near containment overlaps for ALL fragments in the
-  //  first pass, but then only save near containment overlaps for contained fragments, leaving
-  //  the dovetail fragments with a positive count and a NULL pointer.
-  //
-  for (uint32 i=0; i<_fi->numFragments() + 1; i++)
-    if (_best_contains[i].olaps == NULL)
-      _best_contains[i].olapsLen = 0;
+  for (uint32 i=_fi->numFragments() + 1; i>0; i--)
+    _best_contains_olapsBgn[i] = _best_contains_olapsBgn[i-1];
+  _best_contains_olapsBgn[0] = 0;
+
+  for (uint32 i=0; i<_fi->numFragments() + 1; i++) {
+    uint32 *bgn = _best_contains_olaps + _best_contains_olapsBgn[i];
+    uint32 *end = _best_contains_olaps + _best_contains_olapsBgn[i+1];
+
+    if (end - bgn >= 16)
+      std::sort(bgn, end);
+  }
 
 
   //  Diagnostic.  Dump the best edges, count the number of contained
@@ -215,6 +211,104 @@ BestOverlapGraph::BestOverlapGraph(FragmentInfo        *fi,
 BestOverlapGraph::~BestOverlapGraph(){
   delete[] _best_overlaps;
   delete[] _best_contains;
+  delete[] _best_contains_olapsBgn;
+  delete[] _best_contains_olaps;
+}
+
+
+
+//  Feed every overlap in the store to scoreContainment() (pass 1) or
+//  scoreEdge() (pass 2).
+//
+//  With repeat flags (set by markRepeatReads from mer counts), overlaps
+//  to or from a repeat read are ignored; the read is left out of the
+//  graph.  The store is sorted by the A read, so runs of repeat reads are
+//  skipped without reading them.  Resetting the range reopens the
+//  overlap file, so short runs are read and filtered instead.
+//
+#define REPEAT_SKIP_MIN  32
+
+void BestOverlapGraph::scoreOverlaps(OverlapStore *ovs, bool containPass) {
+  OVSoverlap olap;
+
+  if (ovs == NULL)
+    return;
+
+  if (_useRepeatFlags == false) {
+    AS_OVS_resetRangeOverlapStore(ovs);
+
+    while  (AS_OVS_readOverlapFromStore(ovs, &olap, AS_OVS_TYPE_OVL))
+      if (containPass)
+        scoreContainment(olap);
+      else
+        scoreEdge(olap);
+
+    return;
+  }
+
+  uint32  numFrags = _fi->numFragments();
+  uint32  bgn      = 1;
+
+  while (bgn <= numFrags) {
+    while ((bgn <= numFrags) && (_fi->isRepeat(bgn)))
+      bgn++;
+
+    if (bgn > numFrags)
+      break;
+
+    //  Extend the range over non-repeat reads and short runs of repeat
+    //  reads; end is the last non-repeat read in the range.
+
+    uint32  end = bgn;
+    uint32  gap = 0;
+
+    for (uint32 i=bgn+1; (i <= numFrags) && (gap < REPEAT_SKIP_MIN); i++) {
+      if (_fi->isRepeat(i)) {
+        gap++;
+      } else {
+        end = i;
+        gap = 0;
+      }
+    }
+
+    AS_OVS_setRangeOverlapStore(ovs, bgn, end);
+
+    while  (AS_OVS_readOverlapFromStore(ovs, &olap, AS_OVS_TYPE_OVL)) {
+      if ((_fi->isRepeat(olap.a_iid)) ||
+          (_fi->isRepeat(olap.b_iid)))
+        continue;
+
+      if (containPass)
+        scoreContainment(olap);
+      else
+        scoreEdge(olap);
+    }
+
+    bgn = end + 1;
+  }
+}
+
+
+
+//  Pass 1 counted the near-containment overlaps for every fragment in
+//  _best_contains_olapsBgn, but only contained fragments keep them.  Turn
+//  the counts into the begin of each list, laid out back to back in one
+//  array.  Pass 2 uses the begins as the fill position.
+//
+void BestOverlapGraph::allocateContainOlaps(void) {
+  uint64  total = 0;
+
+  for (uint32 i=0; i<_fi->numFragments() + 1; i++) {
+    uint64  len = (_best_contains[i].isContained) ? _best_contains_olapsBgn[i] : 0;
+
+    _best_contains_olapsBgn[i] = total;
+
+    total += len;
+  }
+
+  _best_contains_olapsBgn[_fi->numFragments() + 1] = total;
+
+  _best_contains_olaps = new uint32 [total];
 }
 
 
@@ -232,7 +326,7 @@ void BestOverlapGraph::scoreContainment(const OVSoverlap& olap) {
   //AZ 3 and -3 used to be 10 and -10
   if (((olap.dat.ovl.a_hang >= -10) && (olap.dat.ovl.b_hang <=  0)) ||
       ((olap.dat.ovl.a_hang >=   0) && (olap.dat.ovl.b_hang <= 10)))
-    _best_contains[olap.b_iid].olapsLen++;
+    _best_contains_olapsBgn[olap.b_iid]++;
 
   //  In the case of no hang, make the lower frag the container
   //
@@ -248,17 +342,12 @@ void BestOverlapGraph::scoreContainment(const OVSoverlap& olap) {
     BestContainment      *c = &_best_contains[olap.b_iid];
 
     if (newScr > _best_contains_score[olap.b_iid]) {
-      //  NOTE!  This is already initialized.  We do not need to, and
-      //  it is an error to, initialize olaps to zero!  (We're
-      //  counting olapsLen above, see?  This stupid bug took me about
-      //  an hour to find, grrr.)
       c->container         = olap.a_iid;
       c->a_hang            = olap.dat.ovl.a_hang;
       c->b_hang            = olap.dat.ovl.b_hang;
       c->sameOrientation   = olap.dat.ovl.flipped ? false : true;
       c->isContained       = true;
       c->isPlaced          = false;
-      c->olapsSorted       = false;
 
       _best_contains_score[olap.b_iid] = newScr;
     }
@@ -283,12 +372,9 @@ void BestOverlapGraph::scoreEdge(const OVSoverlap& olap) {
   if (isContained(olap.b_iid)) {
     if (((olap.dat.ovl.a_hang >= -10) && (olap.dat.ovl.b_hang <=  0)) ||
         ((olap.dat.ovl.a_hang >=   0) && (olap.dat.ovl.b_hang <= 10))) {
-      BestContainment *c = &_best_contains[olap.b_iid];
-      if (c->olaps == NULL) {
-        c->olaps    = new uint32 [c->olapsLen];
-        c->olapsLen = 0;
-      }
-      c->olaps[c->olapsLen++] = olap.a_iid;
+      assert(_best_contains_olapsBgn[olap.b_iid] < _best_contains_olapsBgn[olap.b_iid + 1]);
+
+      _best_contains_olaps[_best_contains_olapsBgn[olap.b_iid]++] = olap.a_iid;
     }
     return;
   }
@@ -316,7 +402,8 @@ void BestOverlapGraph::scoreEdge(const OVSoverlap& olap) {
   //  Dove tailing overlap
   uint32           aend    = AEnd(olap);
   BestEdgeOverlap *best    = getBestEdgeOverlap(olap.a_iid, aend);
-  uint64           score   = 0;
+  uint64          *bscr    = _best_overlaps_score + 2 * olap.a_iid + ((aend == THREE_PRIME) ? 1 : 0);
+  uint64           score   = *bscr;
 
   // Store the overlap if:
   //   1.)  The score is better than what is already in the graph
@@ -326,28 +413,17 @@ void BestOverlapGraph::scoreEdge(const OVSoverlap& olap) {
   // store are by A's increasing uint32, by default, if the score and
   // length are the same, the uint32 of the lower value will be kept.
 
-  if (aend == THREE_PRIME)
-    score = _best_overlaps_3p_score[olap.a_iid];
-  else
-    score = _best_overlaps_5p_score[olap.a_iid];
-
   if (newScr > score) {
     best->frag_b_id    = olap.b_iid;
     best->bend         = BEnd(olap);
     best->ahang        = olap.dat.ovl.a_hang;
     best->bhang        = olap.dat.ovl.b_hang;
 
-    if (aend == THREE_PRIME)
-      _best_overlaps_3p_score[olap.a_iid] = newScr;
-    else
-      _best_overlaps_5p_score[olap.a_iid] = newScr;
+    *bscr = newScr;
   }
   else if(newScr == score){
     //fprintf(stderr,"conflicting same score overlap, deleting both %ld %ld new %ld %ld\n", olap.a_iid, best->frag_b_id, olap.a_iid, olap.b_iid);
-    if (aend == THREE_PRIME)
-      _best_overlaps_3p_score[olap.a_iid] = newScr+1;
-    else
-      _best_overlaps_5p_score[olap.a_iid] = newScr+1;
+    *bscr = newScr+1;
 
     best->frag_b_id    = 0;
     best->bend         = 0;
@@ -41,7 +41,7 @@
 #undef ENABLE_CHECKPOINTING
 
 struct BestOverlapGraph {
-  BestOverlapGraph(FragmentInfo *fi, OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept, double erate, double elimit);
+  BestOverlapGraph(FragmentInfo *fi, OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept, double erate, double elimit, bool useRepeatFlags);
   ~BestOverlapGraph();
 
   //  Given a fragment UINT32 and which end, returns pointer to
@@ -72,31 +72,25 @@ struct BestOverlapGraph {
     return((isContained(fragid)) ? &_best_contains[fragid] : NULL);
   };
 
+  //  The near-containment overlaps for each contained fragment are
+  //  stored back to back in _best_contains_olaps, from
+  //  _best_contains_olapsBgn[contain] up to that of the next fragment;
+  //  fragments that are not contained have no list.  Long lists are
+  //  sorted when the graph is built, so this is safe to call from
+  //  multiple threads.
+  //
   bool containHaveEdgeTo(uint32 contain, uint32 otherRead) {
-    BestContainment  *c = &_best_contains[contain];
-    bool              r = false;
+    uint32 *bgn = _best_contains_olaps + _best_contains_olapsBgn[contain];
+    uint32 *end = _best_contains_olaps + _best_contains_olapsBgn[contain + 1];
 
-    if ((c->olapsLen == 0) || (c->olaps == NULL))
-      return(r);
-
-    if (c->isContained == false)
-      return(r);
-
-    if (c->olapsLen < 16) {
-      for (uint32 i=0; i<c->olapsLen; i++)
-        if (c->olaps[i] == otherRead) {
-          r = true;
-          break;
-        }
-    } else {
-      if (c->olapsSorted == false) {
-        std::sort(c->olaps, c->olaps + c->olapsLen);
-        c->olapsSorted = true;
-      }
-      r = std::binary_search(c->olaps, c->olaps + c->olapsLen, otherRead);
+    if (end - bgn < 16) {
+      for (; bgn < end; bgn++)
+        if (*bgn == otherRead)
+          return(true);
+      return(false);
     }
 
-    return(r);
+    return(std::binary_search(bgn, end, otherRead));
   };
 
   // Graph building methods
@@ -245,12 +239,13 @@ struct BestOverlapGraph {
   bool checkForNextFrag(const OVSoverlap& olap);
   void scoreContainment(const OVSoverlap& olap);
   void scoreEdge(const OVSoverlap& olap);
+  void scoreOverlaps(OverlapStore *ovs, bool containPass);
+  void allocateContainOlaps(void);
 
 #ifdef ENABLE_CHECKPOINTING
   void save(void) {
-    assert(_best_overlaps_5p_score == NULL);
-    assert(_best_overlaps_3p_score == NULL);
-    assert(_best_contains_score    == NULL);
+    assert(_best_overlaps_score == NULL);
+    assert(_best_contains_score == NULL);
 
     errno = 0;
     FILE *bogFile = fopen("bog.ckp", "w");
@@ -262,9 +257,8 @@ struct BestOverlapGraph {
     AS_UTL_safeWrite(bogFile, _best_overlaps, "best overlaps", sizeof(BestFragmentOverlap), _fi->numFragments() + 1);
     AS_UTL_safeWrite(bogFile, _best_contains, "best contains", sizeof(BestContainment),     _fi->numFragments() + 1);
 
-    for (uint32 i=0; i<_fi->numFragments() + 1; i++)
-      if (_best_contains[i].olaps != NULL)
-        AS_UTL_safeWrite(bogFile, _best_contains[i].olaps, "best contains olaps", sizeof(uint32), _best_contains[i].olapsLen);
+    AS_UTL_safeWrite(bogFile, _best_contains_olapsBgn, "best contains olaps begin", sizeof(uint64), _fi->numFragments() + 2);
+    AS_UTL_safeWrite(bogFile, _best_contains_olaps,    "best contains olaps",       sizeof(uint32), _best_contains_olapsBgn[_fi->numFragments() + 1]);
 
     fclose(bogFile);
   };
@@ -277,18 +271,16 @@ struct BestOverlapGraph {
 
     assert(_best_overlaps != NULL);
     assert(_best_contains != NULL);
+    assert(_best_contains_olapsBgn != NULL);
 
     AS_UTL_safeRead(bogFile, _best_overlaps, "best overlaps", sizeof(BestFragmentOverlap), _fi->numFragments() + 1);
     AS_UTL_safeRead(bogFile, _best_contains, "best contains", sizeof(BestContainment),     _fi->numFragments() + 1);
 
-    for (uint32 i=0; i<_fi->numFragments() + 1; i++) {
-      if (_best_contains[i].olapsLen > 0) {
-        _best_contains[i].olaps = new uint32 [_best_contains[i].olapsLen];
-        AS_UTL_safeRead(bogFile, _best_contains[i].olaps, "best contains olaps", sizeof(uint32), _best_contains[i].olapsLen);
-      } else {
-        assert(_best_contains[i].olaps == NULL);
-      }
-    }
+    AS_UTL_safeRead(bogFile, _best_contains_olapsBgn, "best contains olaps begin", sizeof(uint64), _fi->numFragments() + 2);
+
+    _best_contains_olaps    = new uint32 [_best_contains_olapsBgn[_fi->numFragments() + 1]];
+
+    AS_UTL_safeRead(bogFile, _best_contains_olaps,    "best contains olaps",       sizeof(uint32), _best_contains_olapsBgn[_fi->numFragments() + 1]);
 
     fclose(bogFile);
 
@@ -299,12 +291,15 @@ struct BestOverlapGraph {
 private:
   BestFragmentOverlap *_best_overlaps;
   BestContainment     *_best_contains;
+  uint64              *_best_contains_olapsBgn;
+  uint32              *_best_contains_olaps;
   FragmentInfo        *_fi;
 
-  uint64              *_best_overlaps_5p_score;
-  uint64              *_best_overlaps_3p_score;
+  uint64              *_best_overlaps_score;   //  5' and 3' scores, interleaved
   uint64              *_best_contains_score;
 
+  bool                 _useRepeatFlags;
+
 public:
   uint64 mismatchCutoff;
   uint64 consensusCutoff;
@@ -104,17 +104,11 @@ public:
 // Contains what kind of containment relationship exists between
 // fragment a and fragment b
 //
-// This needs 93 bits (plus a 64 bit pointer) and must be 8-byte
-// aligned, so the best we can hope for is 24 bytes.
+// This needs 66 bits, so fits in 16 bytes.  The near-containment
+// overlaps are kept by BestOverlapGraph, not here.
 //
 class BestContainment{
 public:
-  BestContainment() {
-  };
-  ~BestContainment() {
-    delete [] olaps;
-  };
-
   uint32  container:31;
   uint32  isContained:1;
 
@@ -123,9 +117,18 @@ public:
 
   uint32  sameOrientation:1;
   uint32  isPlaced:1;
-  uint32  olapsSorted:1;
-  uint32  olapsLen:29;
-  uint32 *olaps;
+};
+
+
+//  Everything we know about a fragment, packed so that one lookup
+//  touches one cache line.
+//
+struct FragmentRecord {
+  uint32  fragLength;
+  uint32  mateIID;
+  uint32  libIID:30;
+  uint32  isRandom:1;
+  uint32  isRepeat:1;
 };
 
 
@@ -138,9 +141,7 @@ public:
     _numLibraries = gkpStore->gkStore_getNumLibraries();
     _numFragments = gkpStore->gkStore_getNumFragments();
 
-    _fragLength    = new uint32 [_numFragments + 1];
-    _mateIID       = new uint32 [_numFragments + 1];
-    _libIID        = new uint32 [_numFragments + 1];
+    _frag          = new FragmentRecord [_numFragments + 1];
 
     _mean          = new double [_numLibraries + 1];
     _stddev        = new double [_numLibraries + 1];
@@ -148,11 +149,7 @@ public:
     _numFragsInLib = new uint32 [_numLibraries + 1];
     _numMatesInLib = new uint32 [_numLibraries + 1];
 
-    for (uint32 i=0; i<_numFragments + 1; i++) {
-      _fragLength[i] = 0;
-      _mateIID[i] = 0;
-      _libIID[i] = 0;
-    }
+    memset(_frag, 0, sizeof(FragmentRecord) * (_numFragments + 1));
 
     for (uint32 i=0; i<_numLibraries + 1; i++) {
       _mean[i]          = 0.0;
@@ -178,13 +175,15 @@ public:
         uint32 iid = fr.gkFragment_getReadIID();
         uint32 lib = fr.gkFragment_getLibraryIID();
 
-        _fragLength[iid] = fr.gkFragment_getClearRegionLength();
-        _mateIID[iid]    = fr.gkFragment_getMateIID();;
-        _libIID[iid]     = lib;
+        _frag[iid].fragLength = fr.gkFragment_getClearRegionLength();
+        _frag[iid].mateIID    = fr.gkFragment_getMateIID();
+        _frag[iid].libIID     = lib;
+        _frag[iid].isRandom   = (fr.gkFragment_getIsNonRandom() == false);
+        _frag[iid].isRepeat   = (fr.gkFragment_getIsRepeat()    != false);
 
         _numFragsInLib[lib]++;
 
-        if (_mateIID[iid])
+        if (_frag[iid].mateIID)
           _numMatesInLib[lib]++;
 
         numLoaded++;
@@ -203,17 +202,17 @@ public:
     delete fs;
   };
   ~FragmentInfo() {
-    delete [] _fragLength;
-    delete [] _mateIID;
-    delete [] _libIID;
+    delete [] _frag;
   };
 
   uint32  numFragments(void) { return(_numFragments); };
   uint32  numLibraries(void) { return(_numLibraries); };
 
-  uint32  fragmentLength(uint32 iid) { return(_fragLength[iid]); };
-  uint32  mateIID(uint32 iid)        { return(_mateIID[iid]); };
-  uint32  libraryIID(uint32 iid)     { return(_libIID[iid]);  };
+  uint32  fragmentLength(uint32 iid) { return(_frag[iid].fragLength); };
+  uint32  mateIID(uint32 iid)        { return(_frag[iid].mateIID); };
+  uint32  libraryIID(uint32 iid)     { return(_frag[iid].libIID);  };
+  bool    isRandom(uint32 iid)       { return(_frag[iid].isRandom); };
+  bool    isRepeat(uint32 iid)       { return(_frag[iid].isRepeat); };
 
   double  mean(uint32 iid)   { return(_mean[iid]); };
   double  stddev(uint32 iid) { return(_stddev[iid]); };
@@ -224,9 +223,7 @@ private:
   uint32   _numFragments;
   uint32   _numLibraries;
 
-  uint32  *_fragLength;
-  uint32  *_mateIID;
-  uint32  *_libIID;
+  FragmentRecord  *_frag;
 
   double  *_mean;
   double  *_stddev;
@@ -21,6 +21,8 @@
 
 // static const char *rcsid = "$Id: AS_BOG_MateChecker.cc,v 1.88 2010/04/02 06:31:52 brianwalenz Exp $";
 
+#include <pthread.h>
+
 #include "AS_BOG_Datatypes.hh"
 #include "AS_BOG_BestOverlapGraph.hh"
 #include "AS_BOG_MateChecker.hh"
@@ -28,6 +30,187 @@
 #include "AS_OVL_overlap.h"  //  For DEFAULT_MIN_OLAP_LEN
 
 
+//  Passes that modify unitigs compute their per-unitig results this many unitigs at a time, then
+//  apply them in order.
+//
+#define MATECHECKER_BATCH  4096
+
+enum MateCheckerPass {
+  MATECHECKER_LIBSTATS,    //  accumulateLibraryStats() into MateCheckerThread::distances
+  MATECHECKER_EVALUATE,    //  evaluateMates() into MateCheckerThread::happiness
+  MATECHECKER_LOCATE,      //  MateLocation (without graphs) into MateCheckerBatch::locs
+  MATECHECKER_BREAKS       //  computeMateCoverage() into MateCheckerBatch::breaks
+};
+
+class MateCheckerThread {
+public:
+  MateCheckerThread() {
+    batch     = NULL;
+    distances = NULL;
+  };
+  ~MateCheckerThread() {
+    delete [] distances;
+  };
+
+  MateCheckerBatch   *batch;
+  vector<uint32>     *distances;    //  per library
+  MateHappiness       happiness;
+};
+
+class MateCheckerBatch {
+public:
+  MateCheckerBatch(MateChecker *mc_, UnitigGraph &tigGraph_, MateCheckerPass pass_) {
+    mc                    = mc_;
+    tigGraph              = &tigGraph_;
+    pass                  = pass_;
+    bgn                   = 0;
+    end                   = 0;
+    next                  = 0;
+    badMateBreakThreshold = 0;
+    locs                  = NULL;
+    breaks                = NULL;
+    threads               = NULL;
+    threadsLen            = 0;
+  };
+  ~MateCheckerBatch() {
+    delete [] locs;
+    delete [] breaks;
+    delete [] threads;
+  };
+
+  MateChecker         *mc;
+  UnitigGraph         *tigGraph;
+  MateCheckerPass      pass;
+
+  uint32               bgn;         //  unitigs to process
+  uint32               end;
+  uint32               next;
+
+  int                  badMateBreakThreshold;
+
+  MateLocation       **locs;        //  locs[ti-bgn], for MATECHECKER_LOCATE
+  UnitigBreakPoints  **breaks;      //  breaks[ti-bgn], for MATECHECKER_BREAKS
+
+  MateCheckerThread   *threads;
+  uint32               threadsLen;
+
+  pthread_mutex_t      mutex;
+};
+
+
+
+void
+MateChecker::batchWork(MateCheckerBatch *b, uint32 ti, MateCheckerThread *t) {
+  Unitig  *utg = (*b->tigGraph->unitigs)[ti];
+
+  switch (b->pass) {
+    case MATECHECKER_LIBSTATS:
+      if ((utg == NULL) ||
+          (utg->dovetail_path_ptr->size() < 2))
+        break;
+      accumulateLibraryStats(utg, t->distances);
+      break;
+
+    case MATECHECKER_EVALUATE:
+      evaluateMates(*b->tigGraph, utg, t->happiness);
+      break;
+
+    case MATECHECKER_LOCATE:
+      if ((utg == NULL) ||
+          (utg->dovetail_path_ptr->empty()) ||
+          (utg->dovetail_path_ptr->size() == 1))
+        break;
+      b->locs[ti - b->bgn] = new MateLocation(_fi, utg, _globalStats, false);
+      break;
+
+    case MATECHECKER_BREAKS:
+      if ((utg == NULL) ||
+          (utg->getNumFrags() < 2))
+        break;
+      b->breaks[ti - b->bgn] = computeMateCoverage(utg, b->tigGraph->bog_ptr, b->badMateBreakThreshold);
+      break;
+  }
+}
+
+
+static
+void *
+mateCheckerThread(void *arg) {
+  MateCheckerThread  *t = (MateCheckerThread *)arg;
+  MateCheckerBatch   *b = t->batch;
+
+  while (1) {
+    pthread_mutex_lock(&b->mutex);
+    uint32  bgn = b->next;
+    uint32  end = MIN(bgn + 64, b->end);
+    b->next = end;
+    pthread_mutex_unlock(&b->mutex);
+
+    if (bgn >= b->end)
+      break;
+
+    for (uint32 ti=bgn; ti<end; ti++)
+      b->mc->batchWork(b, ti, t);
+  }
+
+  return(NULL);
+}
+
+
+//  Runs one pass over unitigs b->bgn .. b->end-1.  Per-thread results are left in b->threads.
+//
+void
+MateChecker::runBatch(MateCheckerBatch *b) {
+
+  delete [] b->threads;
+
+  b->threadsLen = MAX(_numThreads, 1);
+  b->threads    = new MateCheckerThread [b->threadsLen];
+  b->next       = b->bgn;
+
+  for (uint32 t=0; t<b->threadsLen; t++) {
+    b->threads[t].batch = b;
+
+    if (b->pass == MATECHECKER_LIBSTATS)
+      b->threads[t].distances = new vector<uint32> [_fi->numLibraries() + 1];
+  }
+
+  if (b->pass == MATECHECKER_LOCATE) {
+    delete [] b->locs;
+    b->locs = new MateLocation * [b->end - b->bgn];
+    memset(b->locs, 0, sizeof(MateLocation *) * (b->end - b->bgn));
+  }
+
+  if (b->pass == MATECHECKER_BREAKS) {
+    delete [] b->breaks;
+    b->breaks = new UnitigBreakPoints * [b->end - b->bgn];
+    memset(b->breaks, 0, sizeof(UnitigBreakPoints *) * (b->end - b->bgn));
+  }
+
+  if (b->threadsLen == 1) {
+    for (uint32 ti=b->bgn; ti<b->end; ti++)
+      batchWork(b, ti, b->threads);
+    return;
+  }
+
+  pthread_mutex_init(&b->mutex, NULL);
+
+  pthread_t  *tid = new pthread_t [b->threadsLen];
+
+  for (uint32 t=0; t<b->threadsLen; t++) {
+    int err = pthread_create(tid + t, NULL, mateCheckerThread, b->threads + t);
+    if (err)
+      fprintf(stderr, "MateChecker()-- failed to create thread: %s\n", strerror(err)), exit(1);
+  }
+
+  for (uint32 t=0; t<b->threadsLen; t++)
+    pthread_join(tid[t], NULL);
+
+  pthread_mutex_destroy(&b->mutex);
+
+  delete [] tid;
+}
+
 
 
 void MateChecker::checkUnitigGraph(UnitigGraph& tigGraph, int badMateBreakThreshold) {
@@ -65,29 +248,7 @@ void MateChecker::checkUnitigGraph(UnitigGraph& tigGraph, int badMateBreakThresh
   //return;
 
   fprintf(stderr, "==> SPLIT BAD MATES\n");
-  {
-    //  Need to get rid of this cMap guy
-    ContainerMap       cMap;
-
-    for (int  ti=0; ti<tigGraph.unitigs->size(); ti++) {
-      Unitig  *tig = (*tigGraph.unitigs)[ti];
-
-      if ((tig == NULL) || (tig->getNumFrags() < 2))
-        continue;
-
-      UnitigBreakPoints* breaks = computeMateCoverage(tig, tigGraph.bog_ptr, badMateBreakThreshold);
-      UnitigVector*      newUs  = tigGraph.breakUnitigAt(cMap, tig, *breaks);
-
-      if (newUs != NULL) {
-        delete tig;
-        (*tigGraph.unitigs)[ti] = NULL;
-        tigGraph.unitigs->insert(tigGraph.unitigs->end(), newUs->begin(), newUs->end());
-      }
-
-      delete newUs;
-      delete breaks;
-    }
-  }
+  splitBadMates(tigGraph, badMateBreakThreshold);
 
   tigGraph.reportOverlapsUsed("overlaps.aftermatecheck3");
   tigGraph.checkUnitigMembership();
@@ -130,8 +291,51 @@ void MateChecker::checkUnitigGraph(UnitigGraph& tigGraph, int badMateBreakThresh
 
 
 
+//  Break points for a unitig depend only on that unitig, and breaking a unitig changes no other
+//  (existing) unitig, so the break points for a whole batch are found first.  Unitigs made by
+//  breaking are added to the end, and are checked in a later batch.
+//
 void
-MateChecker::accumulateLibraryStats(Unitig *utg) {
+MateChecker::splitBadMates(UnitigGraph &tigGraph, int badMateBreakThreshold) {
+  MateCheckerBatch   b(this, tigGraph, MATECHECKER_BREAKS);
+
+  //  Need to get rid of this cMap guy
+  ContainerMap       cMap;
+
+  b.badMateBreakThreshold = badMateBreakThreshold;
+
+  for (b.bgn=0; b.bgn<tigGraph.unitigs->size(); b.bgn=b.end) {
+    b.end = MIN(b.bgn + MATECHECKER_BATCH, tigGraph.unitigs->size());
+
+    runBatch(&b);
+
+    for (uint32 ti=b.bgn; ti<b.end; ti++) {
+      Unitig             *tig    = (*tigGraph.unitigs)[ti];
+      UnitigBreakPoints  *breaks = b.breaks[ti - b.bgn];
+
+      if (breaks == NULL)
+        continue;
+
+      UnitigVector*      newUs  = tigGraph.breakUnitigAt(cMap, tig, *breaks);
+
+      if (newUs != NULL) {
+        delete tig;
+        (*tigGraph.unitigs)[ti] = NULL;
+        tigGraph.unitigs->insert(tigGraph.unitigs->end(), newUs->begin(), newUs->end());
+      }
+
+      delete newUs;
+      delete breaks;
+    }
+  }
+}
+
+
+
+//  Adds the insert size of each happy mate pair in utg to distances[library].
+//
+void
+MateChecker::accumulateLibraryStats(Unitig *utg, vector<uint32> *distances) {
 
   //  Check each frag in unitig for it's mate
   for (uint32 fi=0; fi<utg->dovetail_path_ptr->size(); fi++) {
@@ -194,19 +398,8 @@ MateChecker::accumulateLibraryStats(Unitig *utg) {
         insertSize = mate->position.bgn - frag->position.bgn;
     }
 
-    if (insertSize > 0) {
-      uint32 di = _fi->libraryIID(frag->ident);
-
-      if (_globalStats[di].distancesMax <= _globalStats[di].distancesLen) {
-        _globalStats[di].distancesMax *= 2;
-        uint32 *d = new uint32 [_globalStats[di].distancesMax];
-        memcpy(d, _globalStats[di].distances, sizeof(uint32) * _globalStats[di].distancesLen);
-        delete [] _globalStats[di].distances;
-        _globalStats[di].distances = d;
-      }
-
-      _globalStats[di].distances[_globalStats[di].distancesLen++] = insertSize;
-    }
+    if (insertSize > 0)
+      distances[_fi->libraryIID(frag->ident)].push_back(insertSize);
   }
 }
 
@@ -224,14 +417,31 @@ void MateChecker::computeGlobalLibStats(UnitigGraph& tigGraph) {
     _globalStats[i].samples  = _fi->numMatesInLib(i);
   }
 
-  for (int  ti=0; ti<tigGraph.unitigs->size(); ti++) {
-    Unitig        *utg = (*tigGraph.unitigs)[ti];
+  MateCheckerBatch  b(this, tigGraph, MATECHECKER_LIBSTATS);
 
-    if ((utg == NULL) ||
-        (utg->dovetail_path_ptr->size() < 2))
-      continue;
+  b.bgn = 0;
+  b.end = tigGraph.unitigs->size();
+
+  runBatch(&b);
+
+  //  Gather the distances from each thread.  They're sorted below, so the order doesn't matter.
+
+  for (uint32 t=0; t<b.threadsLen; t++) {
+    for (uint32 di=0; di < _fi->numLibraries()+1; di++) {
+      vector<uint32>  &dist = b.threads[t].distances[di];
+
+      for (uint32 d=0; d<dist.size(); d++) {
+        if (_globalStats[di].distancesMax <= _globalStats[di].distancesLen) {
+          _globalStats[di].distancesMax *= 2;
+          uint32 *nd = new uint32 [_globalStats[di].distancesMax];
+          memcpy(nd, _globalStats[di].distances, sizeof(uint32) * _globalStats[di].distancesLen);
+          delete [] _globalStats[di].distances;
+          _globalStats[di].distances = nd;
+        }
 
-    accumulateLibraryStats(utg);
+        _globalStats[di].distances[_globalStats[di].distancesLen++] = dist[d];
+      }
+    }
   }
 
   fprintf(stderr, "LIB\tnDist\tmedian\t1/3rd\t2/3rd\tmaxDiff\tmin\tmax\tnumGood\tmean\tstddev\n");
@@ -287,131 +497,139 @@ void MateChecker::computeGlobalLibStats(UnitigGraph& tigGraph) {
 
 
 
+//  Counts mate happiness for the fragments in thisUtg.
+//
 void
-MateChecker::evaluateMates(UnitigGraph &tigGraph) {
+MateChecker::evaluateMates(UnitigGraph &tigGraph, Unitig *thisUtg, MateHappiness &mh) {
 
   //  [0] -- BOTH frag and mate are dovetail
   //  [1] -- ONE frag dovetail, ONE frag contained
   //  [2] -- BOTH frag and mate are contained
 
-  uint64   unmated[3]         = { 0, 0, 0 };
-  uint64   mated[3]           = { 0, 0, 0 };
-  uint64   different[3][3]    = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
-  uint64   happy[3]           = { 0, 0, 0 };
-  uint64   grumpy[3]          = { 0, 0, 0 };
+  if ((thisUtg == NULL) ||
+      (thisUtg->dovetail_path_ptr->empty()) ||
+      (thisUtg->dovetail_path_ptr->size() == 1))
+    return;
 
-  for (int  ti=0; ti<tigGraph.unitigs->size(); ti++) {
-    Unitig  *thisUtg = (*tigGraph.unitigs)[ti];
+  MateLocation          positions(_fi, thisUtg, _globalStats, false);
+
+  for (uint32 fi=0; fi<thisUtg->dovetail_path_ptr->size(); fi++) {
+    DoveTailNode  *thisFrg = &(*thisUtg->dovetail_path_ptr)[fi];
 
-    if ((thisUtg == NULL) ||
-        (thisUtg->dovetail_path_ptr->empty()) ||
-        (thisUtg->dovetail_path_ptr->size() == 1))
+    uint32  thisFrgID = thisFrg->ident;
+    uint32  mateFrgID = _fi->mateIID(thisFrg->ident);
+
+    BestContainment *thiscont = tigGraph.bog_ptr->getBestContainer(thisFrgID);
+    BestContainment *matecont = tigGraph.bog_ptr->getBestContainer(mateFrgID);
+
+    uint32  type = (thiscont != NULL) + (matecont != NULL);
+
+    //  Trivial case, not a mated fragment.
+   //AZ check reciprocity -- if the mate is non-zero and the mate's mate is non-zero -- may be deficiency in the store
+    if (mateFrgID == 0 || _fi->mateIID(mateFrgID) == 0) {
+      mh.unmated[type]++;
       continue;
+    }
 
-    MateLocation          positions(_fi, thisUtg, _globalStats);
+    uint32  thisUtgID = thisUtg->fragIn(thisFrgID);
+    uint32  mateUtgID = thisUtg->fragIn(mateFrgID);
 
-    for (uint32 fi=0; fi<thisUtg->dovetail_path_ptr->size(); fi++) {
-      DoveTailNode  *thisFrg = &(*thisUtg->dovetail_path_ptr)[fi];
+    MateLocationEntry  mloc     = positions.getById(thisFrg->ident);
 
-      uint32  thisFrgID = thisFrg->ident;
-      uint32  mateFrgID = _fi->mateIID(thisFrg->ident);
+    //  Skip this fragment, unless it is mleFrgID1.  Fragments with mates in other unitigs
+    //  are always listed in ID1, and mates completely in this unitig should be counted once.
+    if (mloc.mleFrgID1 != thisFrgID)
+      continue;
 
-      BestContainment *thiscont = tigGraph.bog_ptr->getBestContainer(thisFrgID);
-      BestContainment *matecont = tigGraph.bog_ptr->getBestContainer(mateFrgID);
+    mh.mated[type]++;
 
-      uint32  type = (thiscont != NULL) + (matecont != NULL);
+    //  Easy case, both fragments in the same unitig.
 
-      //  Trivial case, not a mated fragment.
-     //AZ check reciprocity -- if the mate is non-zero and the mate's mate is non-zero -- may be deficiency in the store
-      if (mateFrgID == 0 || _fi->mateIID(mateFrgID) == 0) {
-        unmated[type]++;
-        continue;
-      }
+    if (thisUtgID == mateUtgID) {
+      assert(mloc.mleUtgID1 == thisUtg->id());
+      assert(mloc.mleUtgID2 == thisUtg->id());
+      assert(mloc.mleFrgID1 == thisFrgID);
+      assert(mloc.mleFrgID2 == mateFrgID);
 
-      uint32  thisUtgID = thisUtg->fragIn(thisFrgID);
-      uint32  mateUtgID = thisUtg->fragIn(mateFrgID);
+      if (mloc.isGrumpy == false)
+        mh.happy[type]++;
+      else
+        mh.grumpy[type]++;
+      continue;
+    }
 
-      MateLocationEntry  mloc     = positions.getById(thisFrg->ident);
+    //  Hard case, fragments in different unitigs.  We want to distinguish between
+    //  three cases:
+    //    1) mates at the end that could potentially join unitigs across a gap
+    //    2) mate at the end to an interior mate -- possibly a repeat
+    //    3) both interior mates
 
-      //  Skip this fragment, unless it is mleFrgID1.  Fragments with mates in other unitigs
-      //  are always listed in ID1, and mates completely in this unitig should be counted once.
-      if (mloc.mleFrgID1 != thisFrgID)
-        continue;
+    assert(mloc.mleUtgID1 == thisUtg->id());
+    assert(mloc.mleUtgID2 == 0);
+    assert(mloc.mleFrgID1 == thisFrgID);
+    assert(mloc.mleFrgID2 == 0);
 
-      mated[type]++;
+    //  Get the mate frag.
 
-      //  Easy case, both fragments in the same unitig.
+    Unitig        *mateUtg = (*tigGraph.unitigs)[mateUtgID];
+    DoveTailNode  *mateFrg = &(*mateUtg->dovetail_path_ptr)[mateUtg->pathPosition(mateFrgID)];
 
-      if (thisUtgID == mateUtgID) {
-        assert(mloc.mleUtgID1 == thisUtg->id());
-        assert(mloc.mleUtgID2 == thisUtg->id());
-        assert(mloc.mleFrgID1 == thisFrgID);
-        assert(mloc.mleFrgID2 == mateFrgID);
+    //differentSum[type]++;
 
-        if (mloc.isGrumpy == false)
-          happy[type]++;
-        else
-          grumpy[type]++;
-        continue;
-      }
+    bool  fragIsInterior = false;
+    bool  mateIsInterior = false;
 
-      //  Hard case, fragments in different unitigs.  We want to distinguish between
-      //  three cases:
-      //    1) mates at the end that could potentially join unitigs across a gap
-      //    2) mate at the end to an interior mate -- possibly a repeat
-      //    3) both interior mates
+    uint32  lib           = _fi->libraryIID(thisFrg->ident);
+    uint32  minInsertSize = _globalStats[lib].mean - 3 * _globalStats[lib].stddev;
+    uint32  maxInsertSize = _globalStats[lib].mean + 3 * _globalStats[lib].stddev;
 
-      assert(mloc.mleUtgID1 == thisUtg->id());
-      assert(mloc.mleUtgID2 == 0);
-      assert(mloc.mleFrgID1 == thisFrgID);
-      assert(mloc.mleFrgID2 == 0);
+    if (thisFrg->position.bgn < thisFrg->position.end) {
+      //  Fragment is forward, so mate should be after it.
+      if (thisUtg->getLength() - thisFrg->position.bgn > maxInsertSize)
+        fragIsInterior = true;
+    } else {
+      //  Fragment is reverse, so mate should be before it.
+      if (thisFrg->position.bgn > maxInsertSize)
+        fragIsInterior = true;
+    }
 
-      //  Get the mate frag.
+    if (mateFrg->position.bgn < mateFrg->position.end) {
+      //  Fragment is forward, so mate should be after it.
+      if (mateUtg->getLength() - mateFrg->position.bgn > maxInsertSize)
+        mateIsInterior = true;
+    } else {
+      //  Fragment is reverse, so mate should be before it.
+      if (mateFrg->position.bgn > maxInsertSize)
+        mateIsInterior = true;
+    }
 
-      Unitig        *mateUtg = (*tigGraph.unitigs)[mateUtgID];
-      DoveTailNode  *mateFrg = &(*mateUtg->dovetail_path_ptr)[mateUtg->pathPosition(mateFrgID)];
+    uint32  dtyp = (fragIsInterior == true) + (mateIsInterior == true);
 
-      //differentSum[type]++;
+    mh.different[type][dtyp]++;
+  }
+}
 
-      bool  fragIsInterior = false;
-      bool  mateIsInterior = false;
 
-      uint32  lib           = _fi->libraryIID(thisFrg->ident);
-      uint32  minInsertSize = _globalStats[lib].mean - 3 * _globalStats[lib].stddev;
-      uint32  maxInsertSize = _globalStats[lib].mean + 3 * _globalStats[lib].stddev;
 
-      if (thisFrg->position.bgn < thisFrg->position.end) {
-        //  Fragment is forward, so mate should be after it.
-        if (thisUtg->getLength() - thisFrg->position.bgn > maxInsertSize)
-          fragIsInterior = true;
-      } else {
-        //  Fragment is reverse, so mate should be before it.
-        if (thisFrg->position.bgn > maxInsertSize)
-          fragIsInterior = true;
-      }
+void
+MateChecker::evaluateMates(UnitigGraph &tigGraph) {
+  MateCheckerBatch  b(this, tigGraph, MATECHECKER_EVALUATE);
+  MateHappiness     mh;
 
-      if (mateFrg->position.bgn < mateFrg->position.end) {
-        //  Fragment is forward, so mate should be after it.
-        if (mateUtg->getLength() - mateFrg->position.bgn > maxInsertSize)
-          mateIsInterior = true;
-      } else {
-        //  Fragment is reverse, so mate should be before it.
-        if (mateFrg->position.bgn > maxInsertSize)
-          mateIsInterior = true;
-      }
+  b.bgn = 0;
+  b.end = tigGraph.unitigs->size();
 
-      uint32  dtyp = (fragIsInterior == true) + (mateIsInterior == true);
+  runBatch(&b);
 
-      different[type][dtyp]++;
-    }
-  }
+  for (uint32 t=0; t<b.threadsLen; t++)
+    mh.add(b.threads[t].happiness);
 
   fprintf(stderr, "MATE HAPPINESS (dove/dove):  unmated %11" F_U64P"  mated %11" F_U64P"  sameTig: happy %11" F_U64P" grumpy %11" F_U64P"  diffTig: end-end %11" F_U64P" end-int %11" F_U64P" int-int %11" F_U64P"\n",
-          unmated[0], mated[0], happy[0], grumpy[0], different[0][0], different[0][1], different[0][2]);
+          mh.unmated[0], mh.mated[0], mh.happy[0], mh.grumpy[0], mh.different[0][0], mh.different[0][1], mh.different[0][2]);
   fprintf(stderr, "MATE HAPPINESS (dove/cont):  unmated %11" F_U64P"  mated %11" F_U64P"  sameTig: happy %11" F_U64P" grumpy %11" F_U64P"  diffTig: end-end %11" F_U64P" end-int %11" F_U64P" int-int %11" F_U64P"\n",
-          unmated[1], mated[1], happy[1], grumpy[1], different[1][0], different[1][1], different[1][2]);
+          mh.unmated[1], mh.mated[1], mh.happy[1], mh.grumpy[1], mh.different[1][0], mh.different[1][1], mh.different[1][2]);
   fprintf(stderr, "MATE HAPPINESS (cont/cont):  unmated %11" F_U64P"  mated %11" F_U64P"  sameTig: happy %11" F_U64P" grumpy %11" F_U64P"  diffTig: end-end %11" F_U64P" end-int %11" F_U64P" int-int %11" F_U64P"\n",
-          unmated[2], mated[2], happy[2], grumpy[2], different[2][0], different[2][1], different[2][2]);
+          mh.unmated[2], mh.mated[2], mh.happy[2], mh.grumpy[2], mh.different[2][0], mh.different[2][1], mh.different[2][2]);
 }
 
 
@@ -428,318 +646,354 @@ MateChecker::evaluateMates(UnitigGraph &tigGraph) {
 //  So, our first pass is to move contained fragments around.
 //
 void MateChecker::moveContains(UnitigGraph& tigGraph) {
+  MateCheckerBatch  b(this, tigGraph, MATECHECKER_LOCATE);
+  vector<bool>      changed;
 
-  for (int  ti=0; ti<tigGraph.unitigs->size(); ti++) {
-    Unitig  *thisUnitig = (*tigGraph.unitigs)[ti];
+  //  Fragment placement for a batch of unitigs is found first.  Moving a contained fragment to its
+  //  container changes that unitig; if it hasn't been processed yet, its placement is found again.
 
-    if ((thisUnitig == NULL) ||
-        (thisUnitig->dovetail_path_ptr->empty()) ||
-        (thisUnitig->dovetail_path_ptr->size() == 1))
-      continue;
+  for (b.bgn=0; b.bgn<tigGraph.unitigs->size(); b.bgn=b.end) {
+    b.end = MIN(b.bgn + MATECHECKER_BATCH, tigGraph.unitigs->size());
 
-    MateLocation positions(_fi, thisUnitig, _globalStats);
+    runBatch(&b);
 
-    DoveTailNode         *frags         = new DoveTailNode [thisUnitig->dovetail_path_ptr->size()];
-    int                   fragsLen      = 0;
+    changed.clear();
+    changed.resize(tigGraph.unitigs->size(), false);
 
-    bool                  verbose       = false;
+    for (uint32 ti=b.bgn; ti<b.end; ti++) {
+      Unitig        *thisUnitig = (*tigGraph.unitigs)[ti];
+      MateLocation  *positions  = b.locs[ti - b.bgn];
 
-    if (verbose)
-      fprintf(stderr, "moveContain unitig %d\n", thisUnitig->id());
+      if ((thisUnitig == NULL) ||
+          (thisUnitig->dovetail_path_ptr->empty()) ||
+          (thisUnitig->dovetail_path_ptr->size() == 1)) {
+        delete positions;
+        continue;
+      }
 
-    for (DoveTailIter fragIter = thisUnitig->dovetail_path_ptr->begin();
-         fragIter != thisUnitig->dovetail_path_ptr->end();
-         fragIter++) {
+      if ((positions == NULL) || (changed[ti] == true)) {
+        delete positions;
+        positions = new MateLocation(_fi, thisUnitig, _globalStats, false);
+      }
 
-      BestContainment   *bestcont   = tigGraph.bog_ptr->getBestContainer(fragIter->ident);
-      MateLocationEntry  mloc       = positions.getById(fragIter->ident);
+      moveContains(tigGraph, ti, *positions, changed);
 
-      uint32  thisFrgID = fragIter->ident;
-      uint32  contFrgID = (bestcont) ? bestcont->container : 0;
-      uint32  mateFrgID = _fi->mateIID(fragIter->ident);
+      delete positions;
+    }
+  }
+}
 
-      uint32  thisUtgID = thisUnitig->fragIn(thisFrgID);
-      uint32  contUtgID = thisUnitig->fragIn(contFrgID);
-      uint32  mateUtgID = thisUnitig->fragIn(mateFrgID);
 
-      //  id1 != 0 -> we found the fragment in the mate happiness table
-      //  isBad -> and the mate is unhappy.
-      //
-      //  What's id1 vs id2 in MateLocationEntry?  Dunno.  All I
-      //  know is that if there is no mate present, one of those
-      //  will be 0.  (Similar test used above too.)
-      //
-      bool    isMated    = (mateFrgID > 0);
-      bool    isGrumpy   = ((isMated) && (mloc.mleFrgID1 != 0) && (mloc.mleFrgID2 != 0) && (mloc.isGrumpy == true));
 
-      //
-      //  Figure out what to do.
-      //
+//  Moves or ejects the contained fragments of unitig ti.  Unitigs that receive a fragment are
+//  marked in changed.
+//
+void MateChecker::moveContains(UnitigGraph& tigGraph, uint32 ti, MateLocation &positions, vector<bool> &changed) {
+  Unitig  *thisUnitig = (*tigGraph.unitigs)[ti];
 
-      bool    moveToContainer = false;
-      bool    moveToSingleton = false;
+  DoveTailNode         *frags         = new DoveTailNode [thisUnitig->dovetail_path_ptr->size()];
+  int                   fragsLen      = 0;
 
-      if        ((fragIter->contained == 0) && (bestcont == NULL)) {
-        //  CASE 1:  Not contained.  Leave the fragment here.
-        //fprintf(stderr, "case1 frag %d fragsLen %d\n", thisFrgID, fragsLen);
+  bool                  verbose       = false;
 
-      } else if (isMated == false) {
-        //  CASE 2: Contained but not mated.  Move to be with the
-        //  container (if the container isn't here).
-        //fprintf(stderr, "case2 frag %d contID %d fragsLen %d\n", thisFrgID, contUtgID, fragsLen);
+  if (verbose)
+    fprintf(stderr, "moveContain unitig %d\n", thisUnitig->id());
 
-        if (thisUtgID != contUtgID)
-          moveToContainer = true;
+  for (DoveTailIter fragIter = thisUnitig->dovetail_path_ptr->begin();
+       fragIter != thisUnitig->dovetail_path_ptr->end();
+       fragIter++) {
 
-      } else if ((isGrumpy == true) && (thisUtgID == mateUtgID)) {
-        //  CASE 3: Not happy, and the frag and mate are together.
-        //  Kick out to a singleton.
+    BestContainment   *bestcont   = tigGraph.bog_ptr->getBestContainer(fragIter->ident);
+    MateLocationEntry  mloc       = positions.getById(fragIter->ident);
 
-        //fprintf(stderr, "case3 frag %d utg %d mate %d utg %d cont %d utg %d fragsLen %d\n",
-        //        thisFrgID, thisUtgID, mateFrgID, mateUtgID, contFrgID, contUtgID, fragsLen);
+    uint32  thisFrgID = fragIter->ident;
+    uint32  contFrgID = (bestcont) ? bestcont->container : 0;
+    uint32  mateFrgID = _fi->mateIID(fragIter->ident);
 
-        if (thisUtgID == mateUtgID)
-          moveToSingleton = true;
+    uint32  thisUtgID = thisUnitig->fragIn(thisFrgID);
+    uint32  contUtgID = thisUnitig->fragIn(contFrgID);
+    uint32  mateUtgID = thisUnitig->fragIn(mateFrgID);
 
-      } else {
+    //  id1 != 0 -> we found the fragment in the mate happiness table
+    //  isBad -> and the mate is unhappy.
+    //
+    //  What's id1 vs id2 in MateLocationEntry?  Dunno.  All I
+    //  know is that if there is no mate present, one of those
+    //  will be 0.  (Similar test used above too.)
+    //
+    bool    isMated    = (mateFrgID > 0);
+    bool    isGrumpy   = ((isMated) && (mloc.mleFrgID1 != 0) && (mloc.mleFrgID2 != 0) && (mloc.isGrumpy == true));
 
-        //  This makes for some ugly code (we break the nice if else
-        //  if else structure we had going on) but the next two cases
-        //  need to know if there is an overlap to the rest of the
-        //  unitig.
+    //
+    //  Figure out what to do.
+    //
 
-        bool  hasOverlap   = (thisUtgID == contUtgID);
-        bool  allContained = false;
+    bool    moveToContainer = false;
+    bool    moveToSingleton = false;
 
+    if        ((fragIter->contained == 0) && (bestcont == NULL)) {
+      //  CASE 1:  Not contained.  Leave the fragment here.
+      //fprintf(stderr, "case1 frag %d fragsLen %d\n", thisFrgID, fragsLen);
 
-        if (hasOverlap == false) {
-          if (fragsLen == 0) {
-            //  The first fragment.  Check fragments after to see if
-            //  there is an overlap (note only frags with an overlap
-            //  in the layout are tested).  In rare cases, we ejected
-            //  the container, and left a containee with no overlap to
-            //  fragments remaining.
-            //
-            //  Note that this checks if there is an overlap to the
-            //  very first non-contained (aka dovetail) fragment ONLY.
-            //  If there isn't an overlap to the first non-contained
-            //  fragment, then that fragment will likely NOT align
-            //  correctly.
-
-            DoveTailIter  ft = fragIter + 1;
-
-            //  Skip all the contains.
-            while ((ft != thisUnitig->dovetail_path_ptr->end()) &&
-                   (tigGraph.bog_ptr->isContained(ft->ident) == true) &&
-                   (MAX(fragIter->position.bgn, fragIter->position.end) < MIN(ft->position.bgn, ft->position.end)))
-              ft++;
-
-            //  If the frag is not contained (we could be the
-            //  container), and overlaps in the layout, see if there
-            //  is a real overlap.
-            if ((ft != thisUnitig->dovetail_path_ptr->end()) &&
-                (tigGraph.bog_ptr->isContained(ft->ident) == false) &&
-                (MAX(fragIter->position.bgn, fragIter->position.end) < MIN(ft->position.bgn, ft->position.end)))
-              hasOverlap = tigGraph.bog_ptr->containHaveEdgeTo(thisFrgID, ft->ident);
-          } else {
-            //  Not the first fragment, search for an overlap to an
-            //  already placed frag.
+    } else if (isMated == false) {
+      //  CASE 2: Contained but not mated.  Move to be with the
+      //  container (if the container isn't here).
+      //fprintf(stderr, "case2 frag %d contID %d fragsLen %d\n", thisFrgID, contUtgID, fragsLen);
 
-            DoveTailIter  ft = fragIter;
+      if (thisUtgID != contUtgID)
+        moveToContainer = true;
 
-            do {
-              ft--;
+    } else if ((isGrumpy == true) && (thisUtgID == mateUtgID)) {
+      //  CASE 3: Not happy, and the frag and mate are together.
+      //  Kick out to a singleton.
 
-              //  OK to overlap to a contained frag; he could be our
-              //  container.
+      //fprintf(stderr, "case3 frag %d utg %d mate %d utg %d cont %d utg %d fragsLen %d\n",
+      //        thisFrgID, thisUtgID, mateFrgID, mateUtgID, contFrgID, contUtgID, fragsLen);
 
-              hasOverlap = tigGraph.bog_ptr->containHaveEdgeTo(thisFrgID, ft->ident);
+      if (thisUtgID == mateUtgID)
+        moveToSingleton = true;
 
-              //  Stop if we found an overlap, or we just checked the
-              //  first frag in the unitig, or we no longer overlap in
-              //  the layout.
-            } while ((hasOverlap == false) &&
-                     (ft != thisUnitig->dovetail_path_ptr->begin()) &&
-                     (MIN(fragIter->position.bgn, fragIter->position.end) < MAX(ft->position.bgn, ft->position.end)));
-          }
-        }  //  end of hasOverlap
-
-
-        //  An unbelievabe special case.  When the unitig is just a
-        //  single container fragment (and any contained frags under
-        //  it) rule 4 breaks.  The first fragment has no overlap (all
-        //  later reads are contained) and so we want to eject it to a
-        //  new unitig.  Since there are multiple fragments in this
-        //  unitig, the ejection occurs.  Later, all the contains get
-        //  moved to the new unitig.  And we repeat.  To prevent, we
-        //  abort the ejection if the unitig is all contained in one
-        //  fragment.
-        //
-        if (fragsLen == 0) {
-          allContained = true;
+    } else {
 
-          for (DoveTailIter  ft = fragIter + 1;
-               ((allContained == true) &&
-                (ft != thisUnitig->dovetail_path_ptr->end()));
-               ft++)
-            allContained = tigGraph.bog_ptr->isContained(ft->ident);
-        }
+      //  This makes for some ugly code (we break the nice if else
+      //  if else structure we had going on) but the next two cases
+      //  need to know if there is an overlap to the rest of the
+      //  unitig.
 
+      bool  hasOverlap   = (thisUtgID == contUtgID);
+      bool  allContained = false;
 
 
-        if (isGrumpy == true) {
-          //  CASE 4: Not happy and not with the mate.  This one is a
-          //  bit of a decision.
-          //
-          //  If an overlap exists to the rest of the unitig, we'll
-          //  leave it here.  We'll also leave it here if it is the
-          //  rest of the unitig is all contained in this fragment.
-          //
-          //  If no overlap, and the mate and container are in the
-          //  same unitig, we'll just eject.  That also implies the
-          //  other unitig is somewhat large, at least as big as the
-          //  insert size.
+      if (hasOverlap == false) {
+        if (fragsLen == 0) {
+          //  The first fragment.  Check fragments after to see if
+          //  there is an overlap (note only frags with an overlap
+          //  in the layout are tested).  In rare cases, we ejected
+          //  the container, and left a containee with no overlap to
+          //  fragments remaining.
           //
-          //  Otherwise, we'll move to the container and cross our
-          //  fingers we place it correctly.  The alternative is to
-          //  eject, and hope that we didn't also eject the mate to a
-          //  singleton.
+          //  Note that this checks if there is an overlap to the
+          //  very first non-contained (aka dovetail) fragment ONLY.
+          //  If there isn't an overlap to the first non-contained
+          //  fragment, then that fragment will likely NOT align
+          //  correctly.
+
+          DoveTailIter  ft = fragIter + 1;
+
+          //  Skip all the contains.
+          while ((ft != thisUnitig->dovetail_path_ptr->end()) &&
+                 (tigGraph.bog_ptr->isContained(ft->ident) == true) &&
+                 (MAX(fragIter->position.bgn, fragIter->position.end) < MIN(ft->position.bgn, ft->position.end)))
+            ft++;
+
+          //  If the frag is not contained (we could be the
+          //  container), and overlaps in the layout, see if there
+          //  is a real overlap.
+          if ((ft != thisUnitig->dovetail_path_ptr->end()) &&
+              (tigGraph.bog_ptr->isContained(ft->ident) == false) &&
+              (MAX(fragIter->position.bgn, fragIter->position.end) < MIN(ft->position.bgn, ft->position.end)))
+            hasOverlap = tigGraph.bog_ptr->containHaveEdgeTo(thisFrgID, ft->ident);
+        } else {
+          //  Not the first fragment, search for an overlap to an
+          //  already placed frag.
 
-          //fprintf(stderr, "case4 frag %d utg %d mate %d utg %d cont %d utg %d fragsLen %d\n",
-          //        thisFrgID, thisUtgID, mateFrgID, mateUtgID, contFrgID, contUtgID, fragsLen);
+          DoveTailIter  ft = fragIter;
 
-          if ((hasOverlap == false) && (allContained == false))
-            if (mateUtgID == contUtgID)
-              moveToSingleton = true;
-            else
-              moveToContainer = true;
+          do {
+            ft--;
 
-        } else {
-          //  CASE 5: Happy!  If with container, or an overlap exists to
-          //  some earlier fragment, leave it here.  Otherwise, eject it
-          //  to a singleton.  The fragment is ejected instead of moved
-          //  to be with its container since we don't know which is
-          //  correct - the mate or the overlap.
-          //
-          //  If not happy, we've already made sure that the mate is not
-          //  here (that was case 3).
+            //  OK to overlap to a contained frag; he could be our
+            //  container.
 
-          //fprintf(stderr, "case5 frag %d utg %d mate %d utg %d cont %d utg %d fragsLen %d\n",
-          //        thisFrgID, thisUtgID, mateFrgID, mateUtgID, contFrgID, contUtgID, fragsLen);
+            hasOverlap = tigGraph.bog_ptr->containHaveEdgeTo(thisFrgID, ft->ident);
 
-          //  If no overlap (so not with container or no overlap to
-          //  other frags) eject.
-          if ((hasOverlap == false) && (allContained == false))
-            moveToSingleton = true;
+            //  Stop if we found an overlap, or we just checked the
+            //  first frag in the unitig, or we no longer overlap in
+            //  the layout.
+          } while ((hasOverlap == false) &&
+                   (ft != thisUnitig->dovetail_path_ptr->begin()) &&
+                   (MIN(fragIter->position.bgn, fragIter->position.end) < MAX(ft->position.bgn, ft->position.end)));
         }
-      }  //  End of cases
-
-      //
-      //  Do it.
+      }  //  end of hasOverlap
+
+
+      //  An unbelievabe special case.  When the unitig is just a
+      //  single container fragment (and any contained frags under
+      //  it) rule 4 breaks.  The first fragment has no overlap (all
+      //  later reads are contained) and so we want to eject it to a
+      //  new unitig.  Since there are multiple fragments in this
+      //  unitig, the ejection occurs.  Later, all the contains get
+      //  moved to the new unitig.  And we repeat.  To prevent, we
+      //  abort the ejection if the unitig is all contained in one
+      //  fragment.
       //
+      if (fragsLen == 0) {
+        allContained = true;
+
+        for (DoveTailIter  ft = fragIter + 1;
+             ((allContained == true) &&
+              (ft != thisUnitig->dovetail_path_ptr->end()));
+             ft++)
+          allContained = tigGraph.bog_ptr->isContained(ft->ident);
+      }
 
-      if (moveToContainer == true) {
-        //  Move the fragment to be with its container.
 
-        Unitig         *thatUnitig = (*tigGraph.unitigs)[contUtgID];
-        DoveTailNode    containee  = *fragIter;
 
-        assert(thatUnitig->id() == contUtgID);
+      if (isGrumpy == true) {
+        //  CASE 4: Not happy and not with the mate.  This one is a
+        //  bit of a decision.
+        //
+        //  If an overlap exists to the rest of the unitig, we'll
+        //  leave it here.  We'll also leave it here if it is the
+        //  rest of the unitig is all contained in this fragment.
+        //
+        //  If no overlap, and the mate and container are in the
+        //  same unitig, we'll just eject.  That also implies the
+        //  other unitig is somewhat large, at least as big as the
+        //  insert size.
+        //
+        //  Otherwise, we'll move to the container and cross our
+        //  fingers we place it correctly.  The alternative is to
+        //  eject, and hope that we didn't also eject the mate to a
+        //  singleton.
 
-        //  Nuke the fragment in the current list
-        fragIter->ident        = 999999999;
-        fragIter->contained    = 999999999;
-        fragIter->position.bgn = 0;
-        fragIter->position.end = 0;
+        //fprintf(stderr, "case4 frag %d utg %d mate %d utg %d cont %d utg %d fragsLen %d\n",
+        //        thisFrgID, thisUtgID, mateFrgID, mateUtgID, contFrgID, contUtgID, fragsLen);
 
-        assert(thatUnitig->id() == contUtgID);
+        if ((hasOverlap == false) && (allContained == false))
+          if (mateUtgID == contUtgID)
+            moveToSingleton = true;
+          else
+            moveToContainer = true;
 
-        if (verbose)
-          fprintf(stderr, "Moving contained fragment %d from unitig %d to be with its container %d in unitig %d\n",
-                  thisFrgID, thisUtgID, contFrgID, contUtgID);
+      } else {
+        //  CASE 5: Happy!  If with container, or an overlap exists to
+        //  some earlier fragment, leave it here.  Otherwise, eject it
+        //  to a singleton.  The fragment is ejected instead of moved
+        //  to be with its container since we don't know which is
+        //  correct - the mate or the overlap.
+        //
+        //  If not happy, we've already made sure that the mate is not
+        //  here (that was case 3).
 
-        assert(bestcont->container == contFrgID);
+        //fprintf(stderr, "case5 frag %d utg %d mate %d utg %d cont %d utg %d fragsLen %d\n",
+        //        thisFrgID, thisUtgID, mateFrgID, mateUtgID, contFrgID, contUtgID, fragsLen);
 
-        thatUnitig->addContainedFrag(thisFrgID, bestcont, verbose);
-        assert(thatUnitig->id() == Unitig::fragIn(thisFrgID));
+        //  If no overlap (so not with container or no overlap to
+        //  other frags) eject.
+        if ((hasOverlap == false) && (allContained == false))
+          moveToSingleton = true;
+      }
+    }  //  End of cases
 
-      } else if ((moveToSingleton == true) && (thisUnitig->getNumFrags() != 1)) {
-        //  Eject the fragment to a singleton (unless we ARE the singleton)
-        Unitig        *singUnitig  = new Unitig(verbose);
-        DoveTailNode    containee  = *fragIter;
+    //
+    //  Do it.
+    //
 
-        //  Nuke the fragment in the current list
-        fragIter->ident        = 999999999;
-        fragIter->contained    = 999999999;
-        fragIter->position.bgn = 0;
-        fragIter->position.end = 0;
+    if (moveToContainer == true) {
+      //  Move the fragment to be with its container.
 
-        if (verbose)
-          fprintf(stderr, "Ejecting unhappy contained fragment %d from unitig %d into new unitig %d\n",
-                  thisFrgID, thisUtgID, singUnitig->id());
+      Unitig         *thatUnitig = (*tigGraph.unitigs)[contUtgID];
+      DoveTailNode    containee  = *fragIter;
 
-        containee.contained = 0;
+      assert(thatUnitig->id() == contUtgID);
 
-        singUnitig->addFrag(containee, -MIN(containee.position.bgn, containee.position.end), verbose);
+      //  Nuke the fragment in the current list
+      fragIter->ident        = 999999999;
+      fragIter->contained    = 999999999;
+      fragIter->position.bgn = 0;
+      fragIter->position.end = 0;
 
-        tigGraph.unitigs->push_back(singUnitig);
-        thisUnitig = (*tigGraph.unitigs)[ti];  //  Reset the pointer; unitigs might be reallocated
+      assert(thatUnitig->id() == contUtgID);
 
-      } else {
-        //  Leave fragment here.  Copy the fragment to the list -- if
-        //  we need to rebuild the unitig (because fragments were
-        //  removed), the list is used, otherwise, we have already
-        //  made the changes needed.
-        //
-        //  Also, very important, update our containment mark.  If our
-        //  container was moved, but we stayed put because of a happy
-        //  mate, we're still marked as being contained.  Rather than
-        //  put this check in all the places where we stay put in the
-        //  above if-else-else-else, it's here.
+      if (verbose)
+        fprintf(stderr, "Moving contained fragment %d from unitig %d to be with its container %d in unitig %d\n",
+                thisFrgID, thisUtgID, contFrgID, contUtgID);
 
-        if ((fragIter->contained) && (thisUtgID != contUtgID))
-          fragIter->contained = 0;
+      assert(bestcont->container == contFrgID);
 
-        frags[fragsLen] = *fragIter;
-        fragsLen++;
-      }
+      thatUnitig->addContainedFrag(thisFrgID, bestcont, verbose);
+      assert(thatUnitig->id() == Unitig::fragIn(thisFrgID));
+
+      if (changed.size() <= contUtgID)
+        changed.resize(tigGraph.unitigs->size(), false);
+      changed[contUtgID] = true;
 
-    }  //  over all frags
+    } else if ((moveToSingleton == true) && (thisUnitig->getNumFrags() != 1)) {
+      //  Eject the fragment to a singleton (unless we ARE the singleton)
+      Unitig        *singUnitig  = new Unitig(verbose);
+      DoveTailNode    containee  = *fragIter;
 
-    //  Now, rebuild this unitig if we made changes.
+      //  Nuke the fragment in the current list
+      fragIter->ident        = 999999999;
+      fragIter->contained    = 999999999;
+      fragIter->position.bgn = 0;
+      fragIter->position.end = 0;
 
-    if (fragsLen != thisUnitig->dovetail_path_ptr->size()) {
       if (verbose)
-        fprintf(stderr, "Rebuild unitig %d after removing contained fragments.\n", thisUnitig->id());
+        fprintf(stderr, "Ejecting unhappy contained fragment %d from unitig %d into new unitig %d\n",
+                thisFrgID, thisUtgID, singUnitig->id());
+
+      containee.contained = 0;
 
-      delete thisUnitig->dovetail_path_ptr;
+      singUnitig->addFrag(containee, -MIN(containee.position.bgn, containee.position.end), verbose);
 
-      thisUnitig->dovetail_path_ptr = new DoveTailPath;
+      tigGraph.unitigs->push_back(singUnitig);
+      thisUnitig = (*tigGraph.unitigs)[ti];  //  Reset the pointer; unitigs might be reallocated
 
-      //  Occasionally, we move all fragments out of the original unitig.  Might be worth checking
-      //  if that makes sense!!
+    } else {
+      //  Leave fragment here.  Copy the fragment to the list -- if
+      //  we need to rebuild the unitig (because fragments were
+      //  removed), the list is used, otherwise, we have already
+      //  made the changes needed.
       //
-#warning EMPTIED OUT A UNITIG
-      if (fragsLen > 0) {
-        //  No need to resort.  Offsets only need adjustment if the first fragment is thrown out.
-        //  If not, splitOffset will be zero.
-        //
-        int splitOffset = -MIN(frags[0].position.bgn, frags[0].position.end);
+      //  Also, very important, update our containment mark.  If our
+      //  container was moved, but we stayed put because of a happy
+      //  mate, we're still marked as being contained.  Rather than
+      //  put this check in all the places where we stay put in the
+      //  above if-else-else-else, it's here.
 
-        //  This is where we clean up from the splitting not dealing with contained fragments -- we
-        //  force the first frag to be uncontained.
-        //
-        frags[0].contained = 0;
+      if ((fragIter->contained) && (thisUtgID != contUtgID))
+        fragIter->contained = 0;
 
-        for (int i=0; i<fragsLen; i++)
-          thisUnitig->addFrag(frags[i], splitOffset, verbose);
-      }
+      frags[fragsLen] = *fragIter;
+      fragsLen++;
     }
 
-    delete [] frags;
-    frags = NULL;
+  }  //  over all frags
+
+  //  Now, rebuild this unitig if we made changes.
+
+  if (fragsLen != thisUnitig->dovetail_path_ptr->size()) {
+    if (verbose)
+      fprintf(stderr, "Rebuild unitig %d after removing contained fragments.\n", thisUnitig->id());
+
+    delete thisUnitig->dovetail_path_ptr;
+
+    thisUnitig->dovetail_path_ptr = new DoveTailPath;
+
+    //  Occasionally, we move all fragments out of the original unitig.  Might be worth checking
+    //  if that makes sense!!
+    //
+#warning EMPTIED OUT A UNITIG
+    if (fragsLen > 0) {
+      //  No need to resort.  Offsets only need adjustment if the first fragment is thrown out.
+      //  If not, splitOffset will be zero.
+      //
+      int splitOffset = -MIN(frags[0].position.bgn, frags[0].position.end);
+
+      //  This is where we clean up from the splitting not dealing with contained fragments -- we
+      //  force the first frag to be uncontained.
+      //
+      frags[0].contained = 0;
+
+      for (int i=0; i<fragsLen; i++)
+        thisUnitig->addFrag(frags[i], splitOffset, verbose);
+    }
+  }
 
-  }  //  Over all unitigs
+  delete [] frags;
+  frags = NULL;
 }
 
 
@@ -71,10 +71,49 @@ struct DistanceCompute {
 
 
 
+//  Mate happiness counts reported by evaluateMates().  Index [0] is both frag and mate dovetail, [1]
+//  one dovetail and one contained, [2] both contained.
+//
+struct MateHappiness {
+  uint64   unmated[3];
+  uint64   mated[3];
+  uint64   different[3][3];
+  uint64   happy[3];
+  uint64   grumpy[3];
+
+  MateHappiness() {
+    memset(this, 0, sizeof(MateHappiness));
+  };
+
+  void add(MateHappiness &that) {
+    for (uint32 i=0; i<3; i++) {
+      unmated[i]      += that.unmated[i];
+      mated[i]        += that.mated[i];
+      different[i][0] += that.different[i][0];
+      different[i][1] += that.different[i][1];
+      different[i][2] += that.different[i][2];
+      happy[i]        += that.happy[i];
+      grumpy[i]       += that.grumpy[i];
+    }
+  };
+};
+
+
+class MateLocation;
+class MateCheckerBatch;
+class MateCheckerThread;
+
+
+//  The per-unitig passes -- library statistics, mate happiness, and finding mate based break points
+//  -- run on numThreads threads.  Each thread accumulates its own statistics, and those are summed
+//  when the pass is done.  Changes to unitigs are still made on one thread, in unitig order, so the
+//  result doesn't depend on numThreads.
+//
 struct MateChecker{
-  MateChecker(FragmentInfo *fi) {
+  MateChecker(FragmentInfo *fi, uint32 numThreads=1) {
     _globalStats = NULL;
     _fi          = fi;
+    _numThreads  = numThreads;
   };
   ~MateChecker() {
     delete [] _globalStats;
@@ -82,8 +121,10 @@ struct MateChecker{
 
   void checkUnitigGraph(UnitigGraph &tigGraph, int badMateBreakThreshold);
 
+  void batchWork(MateCheckerBatch *b, uint32 ti, MateCheckerThread *t);
+
 private:
-  void  accumulateLibraryStats(Unitig *utg);
+  void  accumulateLibraryStats(Unitig *utg, vector<uint32> *distances);
   void  computeGlobalLibStats(UnitigGraph &tigGraph);
 
   UnitigBreakPoints* computeMateCoverage(Unitig *utg,
@@ -91,13 +132,20 @@ private:
                                          int badMateBreakThreshold);
 
   void evaluateMates(UnitigGraph &tigGraph);
+  void evaluateMates(UnitigGraph &tigGraph, Unitig *thisUtg, MateHappiness &mh);
 
   void moveContains(UnitigGraph &tigGraph);
+  void moveContains(UnitigGraph &tigGraph, uint32 ti, MateLocation &positions, vector<bool> &changed);
   void splitDiscontinuousUnitigs(UnitigGraph &tigGraph);
 
+  void splitBadMates(UnitigGraph &tigGraph, int badMateBreakThreshold);
+
+  void runBatch(MateCheckerBatch *b);
+
 private:
   DistanceCompute  *_globalStats;
   FragmentInfo     *_fi;
+  uint32            _numThreads;
 };
 
 
@@ -164,7 +212,9 @@ public:
 //
 class MateLocation {
 public:
-  MateLocation(FragmentInfo *fi, Unitig *utg, DistanceCompute *dc) {
+  //  Without graphs, only isGrumpy is computed; goodGraph, badFwdGraph and badRevGraph are NULL.
+  //
+  MateLocation(FragmentInfo *fi, Unitig *utg, DistanceCompute *dc, bool withGraphs=true) {
     MateLocationEntry   mle;
 
     mle.mlePos1.bgn = mle.mlePos1.end = 0;
@@ -183,13 +233,19 @@ public:
 
     _tigLen = utg->getLength();
 
-    goodGraph   = new int32 [_tigLen + 1];
-    badFwdGraph = new int32 [_tigLen + 1];
-    badRevGraph = new int32 [_tigLen + 1];
+    goodGraph   = NULL;
+    badFwdGraph = NULL;
+    badRevGraph = NULL;
+
+    if (withGraphs) {
+      goodGraph   = new int32 [_tigLen + 1];
+      badFwdGraph = new int32 [_tigLen + 1];
+      badRevGraph = new int32 [_tigLen + 1];
 
-    memset(goodGraph,   0, sizeof(int32) * (_tigLen + 1));
-    memset(badFwdGraph, 0, sizeof(int32) * (_tigLen + 1));
-    memset(badRevGraph, 0, sizeof(int32) * (_tigLen + 1));
+      memset(goodGraph,   0, sizeof(int32) * (_tigLen + 1));
+      memset(badFwdGraph, 0, sizeof(int32) * (_tigLen + 1));
+      memset(badRevGraph, 0, sizeof(int32) * (_tigLen + 1));
+    }
 
     _fi = fi;
 
@@ -221,6 +277,9 @@ private:
   void buildHappinessGraphs(Unitig *utg, DistanceCompute *);
 
   void incrRange(int32 *graph, int32 val, int32 n, int32 m) {
+    if (graph == NULL)
+      return;
+
     n = MAX(n, 0);
     m = MIN(m, _tigLen);
 
@@ -25,6 +25,8 @@
 #include "AS_BOG_Unitig.hh"
 #include "AS_BOG_BestOverlapGraph.hh"
 
+#include "AS_UTL_coverageStat.h"
+
 #undef max
 
 #undef DEBUG_PLACEMENT
@@ -54,6 +56,55 @@ Unitig::Unitig(bool report){
 }
 
 
+Unitig::Unitig(uint32 temporaryId){
+  _localArrivalRate = -1;
+  _covStat          = FLT_MAX;
+  _length           = -1;
+  _avgRho           = -1;
+  dovetail_path_ptr = new DoveTailPath;
+  _id               = temporaryId;
+
+  assert(isTemporaryId(_id));
+}
+
+
+void
+Unitig::acceptTemporary(void) {
+
+  assert(isTemporaryId(_id));
+
+  _id = nextId++;
+
+  for (DoveTailIter it=dovetail_path_ptr->begin(); it != dovetail_path_ptr->end(); it++)
+    _inUnitig[it->ident] = _id;
+}
+
+
+void
+Unitig::releaseTemporary(void) {
+
+  assert(isTemporaryId(_id));
+
+  for (DoveTailIter it=dovetail_path_ptr->begin(); it != dovetail_path_ptr->end(); it++) {
+    if (_inUnitig[it->ident] != _id)
+      continue;
+    _pathPosition[it->ident] = 0;
+    claimFrag(it->ident, 0, _id);
+  }
+}
+
+
+bool
+Unitig::ownsAllFrags(void) {
+
+  for (DoveTailIter it=dovetail_path_ptr->begin(); it != dovetail_path_ptr->end(); it++)
+    if (_inUnitig[it->ident] != _id)
+      return(false);
+
+  return(true);
+}
+
+
 Unitig::~Unitig(void){
   delete dovetail_path_ptr;
 }
@@ -682,33 +733,29 @@ void Unitig::setLocalArrivalRate(float local_arrival_rate){
 float Unitig::getLocalArrivalRate(FragmentInfo *fi){
   if (_localArrivalRate != -1 )
     return _localArrivalRate;
-  setLocalArrivalRate((getNumFrags() - 1) / getAvgRho(fi));
+  setLocalArrivalRate(AS_UTL_localArrivalRate(getAvgRho(fi), getNumRandomFrags(fi)));
   return _localArrivalRate;
 }
 
 
-float Unitig::getCovStat(FragmentInfo *fi){
+long Unitig::getNumRandomFrags(FragmentInfo *fi){
+  long  numRandom = 0;
 
-  const float ln2=0.69314718055994530941723212145818;
+  for (DoveTailConstIter it=dovetail_path_ptr->begin(); it != dovetail_path_ptr->end(); it++)
+    if (fi->isRandom(it->ident))
+      numRandom++;
+
+  return(numRandom);
+}
 
-  // Note that we are using numFrags in this calculation.
-  //   If the fragments in the unitig are not randomly sampled
-  //   from the genome, this calculation will be wrong.
-  //   Ie. if fragments being assembled are from a locally
-  //   sequenced batch, the region may look artificially repetitive.
-  //   The value should really be "number of randomly sampled
-  //   fragments in the unitig".
+
+float Unitig::getCovStat(FragmentInfo *fi){
 
   if(_globalArrivalRate==-1)
     fprintf(stderr, "You have not set the _globalArrivalRate variable.\n");
 
-  if(_covStat == FLT_MAX){
-    if(_globalArrivalRate > 0.0){
-      _covStat = (getAvgRho(fi) * _globalArrivalRate) - (ln2 * (getNumFrags() -1));
-    }else{
-      _covStat = 0.0;
-    }
-  }
+  if(_covStat == FLT_MAX)
+    _covStat = AS_UTL_coverageStatistic(getAvgRho(fi), getNumRandomFrags(fi), _globalArrivalRate);
 
   return(_covStat);
 }
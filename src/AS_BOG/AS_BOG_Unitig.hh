@@ -69,6 +69,7 @@ struct BestOverlapGraph;
 
 struct Unitig{
   Unitig(bool report=false);
+  Unitig(uint32 temporaryId);
   ~Unitig(void);
 
   void sort(void);
@@ -82,13 +83,12 @@ struct Unitig{
   float getLocalArrivalRate(FragmentInfo *fi);
   float getCovStat(FragmentInfo *fi);
 
-  // getNumRandomFrags() is a placeholder, random frags should not
-  // contain guides, or other fragments that are not randomly sampled
-  // across the whole genome.
+  // Random frags do not include guides, or other fragments that are
+  // not randomly sampled across the whole genome.
 
   long getLength(void)          { return(_length);                   };
   long getNumFrags(void)        { return(dovetail_path_ptr->size()); };
-  long getNumRandomFrags(void)  { return(getNumFrags());             };
+  long getNumRandomFrags(FragmentInfo *fi);
 
   DoveTailNode getLastBackboneNode(void);
   DoveTailNode getLastBackboneNode(uint32 &);
@@ -115,6 +115,32 @@ struct Unitig{
     return _pathPosition[fragId];
   };
 
+  //  Unitigs built on threads by UnitigGraph::build() get a temporary id, and own their
+  //  fragments by claiming them in _inUnitig.  Accepting one gives it the next real id;
+  //  releasing one returns the fragments it still owns.  A fragment claimed under a temporary
+  //  id is not placed; it can be stolen by another temporary unitig, and a unitig with a real id
+  //  takes it just by adding it.
+  //
+  static const uint32 TEMPORARY_ID = 0x80000000;
+
+  static bool isTemporaryId(uint32 id) {
+    return((id & TEMPORARY_ID) != 0);
+  };
+
+  static bool claimFrag(uint32 fragId, uint32 newId, uint32 oldId=0) {
+    return(__sync_bool_compare_and_swap(_inUnitig + fragId, oldId, newId));
+  };
+
+  static bool fragIsPlaced(uint32 fragId) {
+    uint32  id = fragIn(fragId);
+    return((id != 0) && (isTemporaryId(id) == false));
+  };
+
+  bool ownsAllFrags(void);
+
+  void acceptTemporary(void);
+  void releaseTemporary(void);
+
   static void resetFragUnitigMap(uint32 numFrags) {
     if (_inUnitig == NULL)
       _inUnitig = new uint32[numFrags+1];
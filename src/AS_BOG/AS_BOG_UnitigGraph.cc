@@ -21,11 +21,16 @@
 
 // static const char *rcsid = "$Id: AS_BOG_UnitigGraph.cc,v 1.130 2010/04/27 14:56:58 brianwalenz Exp $";
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+
 #include "AS_BOG_Datatypes.hh"
 #include "AS_BOG_UnitigGraph.hh"
 #include "AS_BOG_BestOverlapGraph.hh"
 
 #include "MultiAlignStore.h"
+#include "AS_UTL_coverageStat.h"
 
 #undef max
 
@@ -162,10 +167,11 @@ UnitigGraph::reportOverlapsUsed(const char *filename) {
 }
 
 
-UnitigGraph::UnitigGraph(FragmentInfo *fi, BestOverlapGraph *bp) {
-  unitigs = new UnitigVector;
-  _fi     = fi;
-  bog_ptr = bp;
+UnitigGraph::UnitigGraph(FragmentInfo *fi, BestOverlapGraph *bp, uint32 numThreads) {
+  unitigs     = new UnitigVector;
+  _fi         = fi;
+  bog_ptr     = bp;
+  _numThreads = numThreads;
 }
 
 UnitigGraph::~UnitigGraph() {
@@ -202,14 +208,19 @@ void UnitigGraph::build(ChunkGraph *cg_ptr,
   unitigs->push_back(NULL);
 
   uint32 frag_idx;
-  while ((frag_idx = cg_ptr->nextFragByChunkLength()) > 0) {
-    if ((_fi->fragmentLength(frag_idx) == 0) ||
-        (Unitig::fragIn(frag_idx) != 0) ||
-        (bog_ptr->isContained(frag_idx) == true))
-      //  Skip deleted fragments, already placed fragments, and contained fragments.
-      continue;
 
-    populateUnitig(frag_idx);
+  if (_numThreads > 1) {
+    populateUnitigs(cg_ptr);
+  } else {
+    while ((frag_idx = cg_ptr->nextFragByChunkLength()) > 0) {
+      if ((_fi->fragmentLength(frag_idx) == 0) ||
+          (Unitig::fragIn(frag_idx) != 0) ||
+          (bog_ptr->isContained(frag_idx) == true))
+        //  Skip deleted fragments, already placed fragments, and contained fragments.
+        continue;
+
+      populateUnitig(frag_idx);
+    }
   }
 
   reportOverlapsUsed("overlaps.afterbuild");
@@ -218,13 +229,17 @@ void UnitigGraph::build(ChunkGraph *cg_ptr,
 
   //  Pick up frags missed above, leftovers from possibly circular unitigs
 
-  for (frag_idx=1; frag_idx <= _fi->numFragments(); frag_idx++) {
-    if ((_fi->fragmentLength(frag_idx) == 0) ||
-        (Unitig::fragIn(frag_idx) != 0) ||
-        (bog_ptr->isContained(frag_idx) == true))
-      continue;
+  if (_numThreads > 1) {
+    populateUnitigs(NULL);
+  } else {
+    for (frag_idx=1; frag_idx <= _fi->numFragments(); frag_idx++) {
+      if ((_fi->fragmentLength(frag_idx) == 0) ||
+          (Unitig::fragIn(frag_idx) != 0) ||
+          (bog_ptr->isContained(frag_idx) == true))
+        continue;
 
-    populateUnitig(frag_idx);
+      populateUnitig(frag_idx);
+    }
   }
 
   reportOverlapsUsed("overlaps.afterbuild2");
@@ -380,9 +395,112 @@ UnitigGraph::setParentAndHang(ChunkGraph *cg) {
 
 
 
+//  A unitig walked on a thread by populateUnitigs(), under a temporary id.  The intersections it
+//  finds are saved, in order, to be applied if the walk is accepted.
+//
+struct UnitigWalkEvent {
+  uint32          invaded;
+  uint32          invader;
+  bool            isSelf;
+};
+
+enum UnitigWalkState {
+  UNITIG_WALK_WAITING,
+  UNITIG_WALK_RUNNING,
+  UNITIG_WALK_ABORT,      //  an earlier walk wants our fragments; give them back
+  UNITIG_WALK_DONE
+};
+
+struct UnitigWalk {
+  uint32                    fragID;
+  uint32                    temporaryId;
+  Unitig                   *utg;        //  NULL if an earlier walk claimed fragID first
+  vector<UnitigWalkEvent>   events;
+  UnitigWalk               *batch;      //  all walks, indexed by temporaryId
+  volatile uint32           state;
+};
+
+
+//  Walking on threads, a fragment claimed by an earlier walk stops us, same as a placed
+//  fragment.  Otherwise, only placed fragments do; a fragment claimed by an unaccepted walk is
+//  taken.
+//
+static
+bool
+isIntersection(uint32 fragId, UnitigWalk *walk) {
+  uint32  id = Unitig::fragIn(fragId);
+
+  if (Unitig::isTemporaryId(id))
+    return((walk != NULL) && (id < walk->temporaryId));
+
+  return(id != 0);
+}
+
+
+//  Claim a fragment for a walk.  A later walk that holds it is told to abort, and we wait for it
+//  to give the fragment back; if that walk is already done, we just take the fragment.  Returns
+//  false if we should stop here, because the fragment is placed, an earlier walk has it, or we
+//  were told to abort.
+//
+static
+bool
+unitigWalkClaim(UnitigWalk *walk, uint32 fragId) {
+
+  while (walk->state == UNITIG_WALK_RUNNING) {
+    uint32  id = Unitig::fragIn(fragId);
+
+    if (id == 0) {
+      if (Unitig::claimFrag(fragId, walk->temporaryId))
+        return(true);
+      continue;
+    }
+
+    if ((Unitig::isTemporaryId(id) == false) ||
+        (id < walk->temporaryId))
+      return(false);
+
+    assert(id != walk->temporaryId);
+
+    UnitigWalk  *other = walk->batch + (id & ~Unitig::TEMPORARY_ID);
+
+    if (other->state == UNITIG_WALK_DONE) {
+      if (Unitig::claimFrag(fragId, walk->temporaryId, id))
+        return(true);
+      continue;
+    }
+
+    __sync_bool_compare_and_swap(&other->state, UNITIG_WALK_RUNNING, UNITIG_WALK_ABORT);
+
+    sched_yield();
+  }
+
+  return(false);
+}
+
+
+void
+UnitigGraph::saveIntersection(uint32      invaded,
+                              uint32      invader,
+                              bool        isSelf,
+                              UnitigWalk *walk) {
+
+  if (walk) {
+    UnitigWalkEvent  ev = { invaded, invader, isSelf };
+    walk->events.push_back(ev);
+    return;
+  }
+
+  unitigIntersect[invaded].push_back(invader);
+
+  if (isSelf)
+    selfIntersect[invader] = true;
+}
+
+
 void
 UnitigGraph::populateUnitig(Unitig           *unitig,
-                            BestEdgeOverlap  *bestnext) {
+                            BestEdgeOverlap  *bestnext,
+                            UnitigWalk       *walk) {
 
   assert(unitig->getLength() > 0);
 
@@ -401,12 +519,12 @@ UnitigGraph::populateUnitig(Unitig           *unitig,
     //  Cicrular unitig.  Deal with later.
     return;
 
-  if (Unitig::fragIn(bestnext->frag_b_id) != 0) {
+  if (isIntersection(bestnext->frag_b_id, walk)) {
     //  Intersection.  Remember.
     if (verboseBuild || verboseBreak)
       fprintf(stderr,"unitigIntersect: unitig %d frag %d -> unitig %d frag %d (before construction)\n",
               unitig->id(), lastID, Unitig::fragIn(bestnext->frag_b_id), bestnext->frag_b_id);
-    unitigIntersect[bestnext->frag_b_id].push_back(lastID);
+    saveIntersection(bestnext->frag_b_id, lastID, false, walk);
     return;
   }
 
@@ -434,6 +552,15 @@ UnitigGraph::populateUnitig(Unitig           *unitig,
 
     frag.ident = bestnext->frag_b_id;
 
+    //  On threads, an earlier walk can claim the fragment after we checked it.  We intersect it,
+    //  same as if it was already placed.
+
+    if ((walk) && (unitigWalkClaim(walk, frag.ident) == false)) {
+      if (walk->state == UNITIG_WALK_RUNNING)
+        saveIntersection(frag.ident, lastID, false, walk);
+      break;
+    }
+
     int32  bidx5 = -1, bidx3 = -1;
 
     if (unitig->placeFrag(frag, bidx5, (bestnext->bend == THREE_PRIME) ? NULL : &bestprev,
@@ -464,17 +591,16 @@ UnitigGraph::populateUnitig(Unitig           *unitig,
         if (verboseBuild || verboseBreak)
           fprintf(stderr,"unitigIntersect: unitig %d frag %d -> unitig %d frag %d (SELF)\n",
                   unitig->id(), lastID, Unitig::fragIn(bestnext->frag_b_id), bestnext->frag_b_id);
-        unitigIntersect[bestnext->frag_b_id].push_back(lastID);
-        selfIntersect[lastID] = true;
+        saveIntersection(bestnext->frag_b_id, lastID, true, walk);
       }
       break;
     }
 
-    if (Unitig::fragIn(bestnext->frag_b_id) != 0) {
+    if (isIntersection(bestnext->frag_b_id, walk)) {
       if (verboseBuild || verboseBreak)
         fprintf(stderr,"unitigIntersect: unitig %d frag %d -> unitig %d frag %d (during construction)\n",
                 unitig->id(), lastID, Unitig::fragIn(bestnext->frag_b_id), bestnext->frag_b_id);
-      unitigIntersect[bestnext->frag_b_id].push_back(lastID);
+      saveIntersection(bestnext->frag_b_id, lastID, false, walk);
       break;
     }
   }
@@ -484,11 +610,20 @@ UnitigGraph::populateUnitig(Unitig           *unitig,
 
 
 void
-UnitigGraph::populateUnitig(int32 frag_idx) {
+UnitigGraph::populateUnitig(int32 frag_idx, UnitigWalk *walk) {
+  Unitig *utg = NULL;
 
-  Unitig *utg = new Unitig(verboseBuild);
+  if (walk == NULL) {
+    utg = new Unitig(verboseBuild);
+    unitigs->push_back(utg);
 
-  unitigs->push_back(utg);
+  } else if (unitigWalkClaim(walk, frag_idx)) {
+    utg = new Unitig(walk->temporaryId);
+    walk->utg = utg;
+
+  } else {
+    return;
+  }
 
   //  Add a first fragment -- to be 'compatable' with the old code, the first fragment is added
   //  reversed, we walk off of its 5' end, flip it, and add the 3' walk.
@@ -522,7 +657,7 @@ UnitigGraph::populateUnitig(int32 frag_idx) {
             utg->dovetail_path_ptr->back().ident, utg->id());
 
   if (bestedge5->frag_b_id)
-    populateUnitig(utg, bestedge5);
+    populateUnitig(utg, bestedge5, walk);
 
   utg->reverseComplement(false);
 
@@ -531,7 +666,7 @@ UnitigGraph::populateUnitig(int32 frag_idx) {
             utg->dovetail_path_ptr->back().ident, utg->id());
 
   if (bestedge3->frag_b_id)
-    populateUnitig(utg, bestedge3);
+    populateUnitig(utg, bestedge3, walk);
 
   //  Enabling this reverse complement is known to degrade the assembly.  It is not known WHY it
   //  degrades the assembly.
@@ -543,6 +678,192 @@ UnitigGraph::populateUnitig(int32 frag_idx) {
 
 
 
+//  Unitigs are walked on threads, a batch of starting fragments at a time, each claiming its
+//  fragments in _inUnitig as it goes.  A walk that runs into a fragment claimed by an earlier walk
+//  stops there, as if that fragment was already placed.  One that runs into a fragment claimed by
+//  a later walk aborts that walk, or takes the fragment if that walk is done.
+//
+//  The walks are then accepted in the order the starting fragments were given.  A walk is exactly
+//  what the serial build would have made if it still owns all its fragments, and every fragment
+//  it stopped at is, by then, placed.  If its starting fragment was placed, it is discarded.
+//  Otherwise, that unitig is built again, serially, taking any fragments claimed by later walks.
+//
+#define UNITIG_WALK_BATCH  1024
+
+class UnitigWalkBatch {
+public:
+  UnitigGraph          *ug;
+  vector<UnitigWalk>    walks;
+  uint32                next;
+  pthread_mutex_t       mutex;
+};
+
+
+void
+UnitigGraph::walkUnitig(UnitigWalk *walk) {
+
+  walk->state = UNITIG_WALK_RUNNING;
+
+  populateUnitig(walk->fragID, walk);
+
+  if (__sync_bool_compare_and_swap(&walk->state, UNITIG_WALK_RUNNING, UNITIG_WALK_DONE))
+    return;
+
+  //  Told to abort.  Give back our fragments, so the earlier walk can continue.
+
+  if (walk->utg)
+    walk->utg->releaseTemporary();
+}
+
+
+static
+void *
+unitigWalkThread(void *arg) {
+  UnitigWalkBatch  *b = (UnitigWalkBatch *)arg;
+
+  while (1) {
+    pthread_mutex_lock(&b->mutex);
+    uint32  i = b->next++;
+    pthread_mutex_unlock(&b->mutex);
+
+    if (i >= b->walks.size())
+      break;
+
+    b->ug->walkUnitig(&b->walks[i]);
+  }
+
+  return(NULL);
+}
+
+
+static
+void
+unitigWalkRelease(UnitigWalk &walk) {
+  if (walk.utg) {
+    walk.utg->releaseTemporary();
+    delete walk.utg;
+  }
+  walk.utg = NULL;
+}
+
+
+static
+bool
+unitigWalkIsExact(UnitigWalk &walk) {
+
+  if ((walk.utg == NULL) ||
+      (walk.utg->ownsAllFrags() == false))
+    return(false);
+
+  for (uint32 e=0; e<walk.events.size(); e++)
+    if ((walk.events[e].isSelf == false) &&
+        (Unitig::fragIsPlaced(walk.events[e].invaded) == false))
+      return(false);
+
+  return(true);
+}
+
+
+//  Builds unitigs from every fragment in chunk length order, or if cg_ptr is NULL, in iid order.
+//
+void
+UnitigGraph::populateUnitigs(ChunkGraph *cg_ptr) {
+  UnitigWalkBatch   b;
+  uint32            iid  = 0;
+  bool              more = true;
+
+  pthread_t        *tid = new pthread_t [_numThreads];
+
+  b.ug = this;
+
+  pthread_mutex_init(&b.mutex, NULL);
+
+  while (more) {
+
+    //  Fill the batch with fragments that can start a unitig: not deleted, not contained, and not
+    //  yet placed.
+
+    b.walks.clear();
+    b.next = 0;
+
+    while (b.walks.size() < UNITIG_WALK_BATCH) {
+      uint32  frag_idx = 0;
+
+      if (cg_ptr)
+        frag_idx = cg_ptr->nextFragByChunkLength();
+      else if (iid < _fi->numFragments())
+        frag_idx = ++iid;
+
+      if (frag_idx == 0) {
+        more = false;
+        break;
+      }
+
+      if ((_fi->fragmentLength(frag_idx) == 0) ||
+          (Unitig::fragIn(frag_idx) != 0) ||
+          (bog_ptr->isContained(frag_idx) == true))
+        continue;
+
+      UnitigWalk  w;
+
+      w.fragID      = frag_idx;
+      w.temporaryId = Unitig::TEMPORARY_ID | b.walks.size();
+      w.utg         = NULL;
+      w.batch       = NULL;
+      w.state       = UNITIG_WALK_WAITING;
+
+      b.walks.push_back(w);
+    }
+
+    if (b.walks.size() == 0)
+      continue;
+
+    for (uint32 i=0; i<b.walks.size(); i++)
+      b.walks[i].batch = &b.walks[0];
+
+    //  Walk.
+
+    for (uint32 t=0; t<_numThreads; t++) {
+      int err = pthread_create(tid + t, NULL, unitigWalkThread, &b);
+      if (err)
+        fprintf(stderr, "populateUnitigs()-- failed to create thread: %s\n", strerror(err)), exit(1);
+    }
+
+    for (uint32 t=0; t<_numThreads; t++)
+      pthread_join(tid[t], NULL);
+
+    //  Accept, in order.
+
+    for (uint32 i=0; i<b.walks.size(); i++) {
+      UnitigWalk  &w = b.walks[i];
+
+      if (Unitig::fragIsPlaced(w.fragID)) {
+        unitigWalkRelease(w);
+        continue;
+      }
+
+      if (unitigWalkIsExact(w) == false) {
+        unitigWalkRelease(w);
+        populateUnitig(w.fragID);
+        continue;
+      }
+
+      w.utg->acceptTemporary();
+      unitigs->push_back(w.utg);
+
+      for (uint32 e=0; e<w.events.size(); e++)
+        saveIntersection(w.events[e].invaded, w.events[e].invader, w.events[e].isSelf, NULL);
+    }
+  }
+
+  pthread_mutex_destroy(&b.mutex);
+
+  delete [] tid;
+}
+
+
+
+
 void UnitigGraph::breakUnitigs(ContainerMap &cMap, char *output_prefix) {
   FILE *breakFile;
 
@@ -1290,379 +1611,736 @@ UnitigGraph::placeZombies(void) {
 }
 
 
-//  Sometimes, we don't include fragments into a unitig, even though the best overlap off of both
-//  ends is to the same unitig.  This will include those.
+//  The overlaps popBubbles() needs, loaded once.
+//
+//  Fragments are loaded in iid order, as a few long ranges instead of
+//  one seek per fragment; fragments closer than BUBBLE_OVERLAP_GAP
+//  share a range.  Overlaps from the unique store come before those
+//  from the repeat store, just as reading one fragment at a time
+//  returns them.  A fragment that was not loaded is read from the
+//  stores when asked for; only the (single threaded) merge pass does
+//  that.
 //
-void
-UnitigGraph::popBubbles(OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept) {
-
 #define MAX_OVERLAPS_PER_FRAG   (16 * 1024 * 1024)
+#define BUBBLE_OVERLAP_GAP      1024
 
-  uint32      ovlMax = MAX_OVERLAPS_PER_FRAG;
-  uint32      ovlLen = 0;
-  OVSoverlap *ovl    = (OVSoverlap *)safe_malloc(sizeof(OVSoverlap) * ovlMax);
-  uint32     *ovlCnt = (uint32     *)safe_malloc(sizeof(uint32)     * AS_READ_MAX_NORMAL_LEN);
+struct BubbleOverlap {
+  uint32    b_iid;
+  int32     a_hang;
+  int32     b_hang;
+};
 
-  uint32      nBubblePopped   = 0;
-  uint32      nBubbleTooBig   = 0;
-  uint32      nBubbleConflict = 0;
+class BubbleOverlaps {
+public:
+  BubbleOverlaps(OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept) {
+    _ovlStoreUniq = ovlStoreUniq;
+    _ovlStoreRept = ovlStoreRept;
+    _ovl          = (OVSoverlap *)safe_malloc(sizeof(OVSoverlap) * MAX_OVERLAPS_PER_FRAG);
+  };
+  ~BubbleOverlaps() {
+    safe_free(_ovl);
+  };
+
+  void   load(vector<uint32> &frags) {
+    vector<BubbleOverlap>  uniq, rept;
+    vector<uint64>         uniqBgn, reptBgn;
+
+    _frags = frags;
+
+    std::sort(_frags.begin(), _frags.end());
+    _frags.erase(std::unique(_frags.begin(), _frags.end()), _frags.end());
+
+    loadStore(_ovlStoreUniq, uniq, uniqBgn);
+    loadStore(_ovlStoreRept, rept, reptBgn);
+
+    _bgn.resize(_frags.size() + 1);
+    _list.clear();
+    _list.reserve(uniq.size() + rept.size());
+
+    for (uint32 i=0; i<_frags.size(); i++) {
+      _bgn[i] = _list.size();
+      _list.insert(_list.end(), uniq.begin() + uniqBgn[i], uniq.begin() + uniqBgn[i+1]);
+      _list.insert(_list.end(), rept.begin() + reptBgn[i], rept.begin() + reptBgn[i+1]);
+    }
+    _bgn[_frags.size()] = _list.size();
+  };
+
+  //  Returns the overlaps for fragment iid in list/len.
+  void   get(uint32 iid, BubbleOverlap *&list, uint32 &len) {
+    vector<uint32>::iterator  it = std::lower_bound(_frags.begin(), _frags.end(), iid);
+
+    if ((it != _frags.end()) && (*it == iid)) {
+      uint32  i = it - _frags.begin();
+      list = (_bgn[i] == _bgn[i+1]) ? NULL : &_list[_bgn[i]];
+      len  = _bgn[i+1] - _bgn[i];
+      return;
+    }
 
-  fprintf(stderr, "==> SEARCHING FOR BUBBLES\n");
+    _miss.clear();
 
-  for (int  ti=0; ti<unitigs->size(); ti++) {
-    Unitig        *shortTig = (*unitigs)[ti];
-    Unitig        *mergeTig = NULL;
+    if (_ovlStoreUniq) {
+      AS_OVS_setRangeOverlapStore(_ovlStoreUniq, iid, iid);
+      append(_miss, AS_OVS_readOverlapsFromStore(_ovlStoreUniq, _ovl, MAX_OVERLAPS_PER_FRAG, AS_OVS_TYPE_ANY));
+    }
 
-    if ((shortTig == NULL) ||
-        (shortTig->dovetail_path_ptr == NULL) ||
-        (shortTig->dovetail_path_ptr->size() >= 30))
-      continue;
+    if (_ovlStoreRept) {
+      AS_OVS_setRangeOverlapStore(_ovlStoreRept, iid, iid);
+      append(_miss, AS_OVS_readOverlapsFromStore(_ovlStoreRept, _ovl, MAX_OVERLAPS_PER_FRAG, AS_OVS_TYPE_ANY));
+    }
 
-    uint32         otherUtg     = 987654321;
-    uint32         conflicts    = 0;
-    uint32         self         = 0;
-    uint32         nonmated     = 0;
-    uint32         matedcont    = 0;
-    uint32         spurs        = 0;
+    list = (_miss.size() == 0) ? NULL : &_miss[0];
+    len  = _miss.size();
+  };
 
-    uint32         diffOrient   = 0;
-    uint32         tooLong      = 0;
-    uint32         tigLong      = 0;
-    uint32         tigShort     = 0;
+private:
+  void   append(vector<BubbleOverlap> &list, uint32 ovlLen) {
+    for (uint32 o=0; o<ovlLen; o++) {
+      BubbleOverlap  bo;
 
-    uint32         tooDifferent = 0;
+      bo.b_iid  = _ovl[o].b_iid;
+      bo.a_hang = _ovl[o].dat.ovl.a_hang;
+      bo.b_hang = _ovl[o].dat.ovl.b_hang;
 
-    int32          minNewPos    = INT32_MAX;
-    int32          maxNewPos    = INT32_MIN;
+      list.push_back(bo);
+    }
+  };
 
-    for (int fi=0; fi<shortTig->dovetail_path_ptr->size(); fi++) {
-      DoveTailNode *frg = &(*shortTig->dovetail_path_ptr)[fi];
+  void   loadStore(OverlapStore *ovs, vector<BubbleOverlap> &list, vector<uint64> &bgn) {
+    uint32  next = 0;
 
-      int32  frgID = frg->ident;
-      int32  utgID = shortTig->id();
+    bgn.resize(_frags.size() + 1);
 
-      BestEdgeOverlap *bestedge5 = bog_ptr->getBestEdgeOverlap(frg->ident, FIVE_PRIME);
-      BestEdgeOverlap *bestedge3 = bog_ptr->getBestEdgeOverlap(frg->ident, THREE_PRIME);
-      BestContainment *bestcont  = bog_ptr->getBestContainer(frg->ident);
+    for (uint32 r=0; (ovs != NULL) && (r < _frags.size()); ) {
+      uint32  rEnd = r + 1;
 
-      if (_fi->mateIID(frgID) > 0) {
-        if (bestcont)
-          matedcont++;
-      } else {
-        nonmated++;
-      }
+      while ((rEnd < _frags.size()) && (_frags[rEnd] - _frags[rEnd-1] < BUBBLE_OVERLAP_GAP))
+        rEnd++;
 
-      if (bestcont)
-        continue;
+      AS_OVS_setRangeOverlapStore(ovs, _frags[r], _frags[rEnd-1]);
 
-      if (bestedge5->frag_b_id == 0) {
-        spurs++;
-      } else {
-        int32 ou5 = shortTig->fragIn(bestedge5->frag_b_id);
+      uint32  ovlLen = 0;
 
-        assert(ou5 > 0);
+      while ((ovlLen = AS_OVS_readOverlapsFromStore(ovs, _ovl, MAX_OVERLAPS_PER_FRAG, AS_OVS_TYPE_ANY)) > 0) {
+        uint32  iid = _ovl[0].a_iid;
 
-        if (ou5 == shortTig->id()) {
-          self++;
-        } else {
-          if ((otherUtg == 987654321) && (ou5 != 0))
-            otherUtg = ou5;
-          if (otherUtg != ou5)
-            conflicts++;
+        while ((next < _frags.size()) && (_frags[next] < iid))
+          bgn[next++] = list.size();
+
+        if ((next < _frags.size()) && (_frags[next] == iid)) {
+          bgn[next++] = list.size();
+          append(list, ovlLen);
         }
       }
 
-      if (bestedge3->frag_b_id == 0) {
-        spurs++;
+      r = rEnd;
+    }
+
+    while (next <= _frags.size())
+      bgn[next++] = list.size();
+  };
+
+  OverlapStore           *_ovlStoreUniq;
+  OverlapStore           *_ovlStoreRept;
+  OVSoverlap             *_ovl;
+
+  vector<uint32>          _frags;   //  sorted
+  vector<uint64>          _bgn;     //  overlaps for _frags[i] are _list[_bgn[i]] .. _list[_bgn[i+1]-1]
+  vector<BubbleOverlap>   _list;
+  vector<BubbleOverlap>   _miss;
+};
+
+
+
+static
+void
+bubbleLog(string &log, const char *fmt, ...) {
+  char     line[1024];
+  va_list  ap;
+
+  va_start(ap, fmt);
+  vsnprintf(line, 1024, fmt, ap);
+  va_end(ap);
+
+  log.append(line);
+}
+
+
+
+//  Decides if shortTig can be placed in some other unitig.  This is the first half of the test
+//  for a bubble, and needs no overlaps.  On return, ev.verdict is BUBBLE_CONFLICT if the placement
+//  is bad, BUBBLE_NONE if there is no placement, and BUBBLE_CANDIDATE otherwise.
+//
+//  ev.readTigs lists every unitig the verdict looked at: shortTig, the unitigs its best edges
+//  go to, and the unitig it would merge into.  Merging changes only the two unitigs involved, so
+//  the verdict stands as long as none of these were merged.
+//
+void
+UnitigGraph::placeBubble(Unitig *shortTig, BubbleEvaluation &ev) {
+
+  ev.verdict   = BUBBLE_NONE;
+  ev.mergeID   = 0;
+  ev.minNewPos = INT32_MAX;
+  ev.maxNewPos = INT32_MIN;
+  ev.readTigs.clear();
+  ev.log.clear();
+
+  if ((shortTig == NULL) ||
+      (shortTig->dovetail_path_ptr == NULL) ||
+      (shortTig->dovetail_path_ptr->size() >= 30))
+    return;
+
+  ev.readTigs.push_back(shortTig->id());
+
+  Unitig        *mergeTig     = NULL;
+
+  uint32         otherUtg     = 987654321;
+  uint32         conflicts    = 0;
+  uint32         self         = 0;
+  uint32         nonmated     = 0;
+  uint32         matedcont    = 0;
+  uint32         spurs        = 0;
+
+  uint32         diffOrient   = 0;
+  uint32         tooLong      = 0;
+  uint32         tigLong      = 0;
+  uint32         tigShort     = 0;
+
+  uint32         tooDifferent = 0;
+
+  int32          minNewPos    = INT32_MAX;
+  int32          maxNewPos    = INT32_MIN;
+
+  for (int fi=0; fi<shortTig->dovetail_path_ptr->size(); fi++) {
+    DoveTailNode *frg = &(*shortTig->dovetail_path_ptr)[fi];
+
+    int32  frgID = frg->ident;
+    int32  utgID = shortTig->id();
+
+    BestEdgeOverlap *bestedge5 = bog_ptr->getBestEdgeOverlap(frg->ident, FIVE_PRIME);
+    BestEdgeOverlap *bestedge3 = bog_ptr->getBestEdgeOverlap(frg->ident, THREE_PRIME);
+    BestContainment *bestcont  = bog_ptr->getBestContainer(frg->ident);
+
+    if (_fi->mateIID(frgID) > 0) {
+      if (bestcont)
+        matedcont++;
+    } else {
+      nonmated++;
+    }
+
+    if (bestcont)
+      continue;
+
+    if (bestedge5->frag_b_id == 0) {
+      spurs++;
+    } else {
+      int32 ou5 = shortTig->fragIn(bestedge5->frag_b_id);
+
+      assert(ou5 > 0);
+
+      ev.readTigs.push_back(ou5);
+
+      if (ou5 == shortTig->id()) {
+        self++;
       } else {
-        int32 ou3 = shortTig->fragIn(bestedge3->frag_b_id);
+        if ((otherUtg == 987654321) && (ou5 != 0))
+          otherUtg = ou5;
+        if (otherUtg != ou5)
+          conflicts++;
+      }
+    }
 
-        assert(ou3 > 0);
+    if (bestedge3->frag_b_id == 0) {
+      spurs++;
+    } else {
+      int32 ou3 = shortTig->fragIn(bestedge3->frag_b_id);
 
-        if (ou3 == shortTig->id()) {
-          self++;
-        } else {
-          if ((otherUtg == 987654321) && (ou3 != 0))
-            otherUtg = ou3;
-          if (otherUtg != ou3)
-            conflicts++;
-        }
+      assert(ou3 > 0);
+
+      ev.readTigs.push_back(ou3);
+
+      if (ou3 == shortTig->id()) {
+        self++;
+      } else {
+        if ((otherUtg == 987654321) && (ou3 != 0))
+          otherUtg = ou3;
+        if (otherUtg != ou3)
+          conflicts++;
       }
+    }
 
-      if (otherUtg == 987654321)
-        //  Didn't find a unitig to merge this fragment into.
-        continue;
+    if (otherUtg == 987654321)
+      //  Didn't find a unitig to merge this fragment into.
+      continue;
 
-      if (conflicts > 0)
-        //  Found multiple unitigs to merge this fragment into, or multiple unitigs to merge this unitig into.
-        continue;
+    if (conflicts > 0)
+      //  Found multiple unitigs to merge this fragment into, or multiple unitigs to merge this unitig into.
+      continue;
 
-      //  Check sanity of the new placement.
+    //  Check sanity of the new placement.
 
-      mergeTig = (*unitigs)[otherUtg];
+    mergeTig = (*unitigs)[otherUtg];
 
-      DoveTailNode place5;
-      DoveTailNode place3;
+    DoveTailNode place5;
+    DoveTailNode place3;
 
-      place5.ident = frgID;
-      place3.ident = frgID;
+    place5.ident = frgID;
+    place3.ident = frgID;
 
-      int32 bidx5 = -1;
-      int32 bidx3 = -1;
+    int32 bidx5 = -1;
+    int32 bidx3 = -1;
 
-      mergeTig->placeFrag(place5, bidx5, bestedge5,
-                          place3, bidx3, bestedge3);
+    mergeTig->placeFrag(place5, bidx5, bestedge5,
+                        place3, bidx3, bestedge3);
 
-      //  Either or both ends can fail to place in the new unitig -- edges can be to a fragment in
-      //  the tig we're testing.  This doesn't matter for finding the min/max, but does matter
-      //  when we decide if the placements are about the correct size.
+    //  Either or both ends can fail to place in the new unitig -- edges can be to a fragment in
+    //  the tig we're testing.  This doesn't matter for finding the min/max, but does matter
+    //  when we decide if the placements are about the correct size.
 
-      //  Update the min/max placement for the whole tig.  At the end of everyhing we'll
-      //  make sure the min/max agree with the size of the tig.
+    //  Update the min/max placement for the whole tig.  At the end of everyhing we'll
+    //  make sure the min/max agree with the size of the tig.
 
-      int32  min5 = INT32_MAX, max5 = INT32_MIN;
-      int32  min3 = INT32_MAX, max3 = INT32_MIN;
+    int32  min5 = INT32_MAX, max5 = INT32_MIN;
+    int32  min3 = INT32_MAX, max3 = INT32_MIN;
 
-      int32  minU = INT32_MAX;
-      int32  maxU = INT32_MIN;
+    int32  minU = INT32_MAX;
+    int32  maxU = INT32_MIN;
 
-      if (bidx5 != -1) {
+    if (bidx5 != -1) {
 #ifdef DEBUG_MERGE
-        fprintf(stderr, "popBubbles()-- place frag %d using 5' edge at %d,%d\n", frgID, place5.position.bgn, place5.position.end);
+      bubbleLog(ev.log, "popBubbles()-- place frag %d using 5' edge at %d,%d\n", frgID, place5.position.bgn, place5.position.end);
 #endif
-        min5 = MIN(place5.position.bgn, place5.position.end);
-        max5 = MAX(place5.position.bgn, place5.position.end);
-      }
+      min5 = MIN(place5.position.bgn, place5.position.end);
+      max5 = MAX(place5.position.bgn, place5.position.end);
+    }
 
-      if (bidx3 != -1) {
+    if (bidx3 != -1) {
 #ifdef DEBUG_MERGE
-        fprintf(stderr, "popBubbles()-- place frag %d using 3' edge at %d,%d\n", frgID, place3.position.bgn, place3.position.end);
+      bubbleLog(ev.log, "popBubbles()-- place frag %d using 3' edge at %d,%d\n", frgID, place3.position.bgn, place3.position.end);
 #endif
-        min3 = MIN(place3.position.bgn, place3.position.end);
-        max3 = MAX(place3.position.bgn, place3.position.end);
-      }
+      min3 = MIN(place3.position.bgn, place3.position.end);
+      max3 = MAX(place3.position.bgn, place3.position.end);
+    }
 
-      minU = MIN(min5, min3);
-      maxU = MAX(max5, max3);
+    minU = MIN(min5, min3);
+    maxU = MAX(max5, max3);
 
-      minNewPos = MIN(minU, minNewPos);
-      maxNewPos = MAX(maxU, maxNewPos);
+    minNewPos = MIN(minU, minNewPos);
+    maxNewPos = MAX(maxU, maxNewPos);
 
-      //  Check that the two placements agree with each other.  Same orientation, more or less the
-      //  same location, more or less the correct length.  For the location, we only need to test
-      //  that the min and max positions are roughly the same as the fragment length.  If the two
-      //  edges place the fragment in different locations, then the min/max values of the placement
-      //  will be too large (never too small).
+    //  Check that the two placements agree with each other.  Same orientation, more or less the
+    //  same location, more or less the correct length.  For the location, we only need to test
+    //  that the min and max positions are roughly the same as the fragment length.  If the two
+    //  edges place the fragment in different locations, then the min/max values of the placement
+    //  will be too large (never too small).
 
-      if ((bidx5 != -1) && (bidx3 != -1)) {
-        if ((min5 < max5) != (min3 < max3))
-          //  Orientation bad.
-          diffOrient++;
+    if ((bidx5 != -1) && (bidx3 != -1)) {
+      if ((min5 < max5) != (min3 < max3))
+        //  Orientation bad.
+        diffOrient++;
 
-        if (maxU - minU > (1 + 2 * 0.03) * _fi->fragmentLength(frgID))
-          //  Location bad.
-          tooLong++;
+      if (maxU - minU > (1 + 2 * 0.03) * _fi->fragmentLength(frgID))
+        //  Location bad.
+        tooLong++;
 
-        if (max5 - min5 > (1 + 2 * 0.03) * _fi->fragmentLength(frgID))
-          //  Length bad.
-          tooLong++;
+      if (max5 - min5 > (1 + 2 * 0.03) * _fi->fragmentLength(frgID))
+        //  Length bad.
+        tooLong++;
 
-        if (max3 - min3 > (1 + 2 * 0.03) * _fi->fragmentLength(frgID))
-          //  Length bad.
-          tooLong++;
-      }
-    }  //  Over all fragments in the source unitig/
+      if (max3 - min3 > (1 + 2 * 0.03) * _fi->fragmentLength(frgID))
+        //  Length bad.
+        tooLong++;
+    }
+  }  //  Over all fragments in the source unitig/
 
-    //
-    //  If we are bad already, just stop.  If we pass these tests, continue on to checking overlaps.
-    //
+  if (mergeTig)
+    ev.readTigs.push_back(mergeTig->id());
+
+  std::sort(ev.readTigs.begin(), ev.readTigs.end());
+  ev.readTigs.erase(std::unique(ev.readTigs.begin(), ev.readTigs.end()), ev.readTigs.end());
+
+  //
+  //  If we are bad already, just stop.  If we pass these tests, continue on to checking overlaps.
+  //
 
 #warning NEED TO SET AS_UTG_ERROR_RATE
 #warning NEED TO SET AS_UTG_ERROR_RATE
 #warning NEED TO SET AS_UTG_ERROR_RATE
-    if (maxNewPos - minNewPos > (1 + 2 * 0.03) * shortTig->getLength())
-      //  Bad placement; edges indicate we blew the unitig apart.
-      tigLong++;
+  if (maxNewPos - minNewPos > (1 + 2 * 0.03) * shortTig->getLength())
+    //  Bad placement; edges indicate we blew the unitig apart.
+    tigLong++;
 
-    if (maxNewPos - minNewPos > (1 - 2 * 0.03) * shortTig->getLength())
-      //  Bad placement; edges indicate we compressed the unitig (usually by placing only one fragment)
-      tigShort++;
+  if (maxNewPos - minNewPos > (1 - 2 * 0.03) * shortTig->getLength())
+    //  Bad placement; edges indicate we compressed the unitig (usually by placing only one fragment)
+    tigShort++;
 
 #ifdef DEBUG_MERGE
-    fprintf(stderr, "popBubbles()-- unitig %d CONFLICTS %d SPURS %d SELF %d len %d frags %d matedcont %d nonmated %d diffOrient %d tooLong %d tigLong %d tigShort %d\n",
+  bubbleLog(ev.log, "popBubbles()-- unitig %d CONFLICTS %d SPURS %d SELF %d len %d frags %d matedcont %d nonmated %d diffOrient %d tooLong %d tigLong %d tigShort %d\n",
             shortTig->id(), conflicts, spurs, self, shortTig->getLength(), shortTig->dovetail_path_ptr->size(), matedcont, nonmated, diffOrient, tooLong, tigLong, tigShort);
 #endif
 
 #if 1
-    //  This rule is possible too aggressive.  It was originally used before CHECK_OVERLAPS existed.
-    //  That should catch what 'self' and 'matedcont' were trying to catch.
-    if ((spurs        > 0) ||
-        (self         > 6) ||
-        (matedcont    > 6) ||
-        (diffOrient   > 0) ||
-        (tooLong      > 0) ||
-        (tigLong      > 0) ||
-        (tigShort     > 0) ||
-        (tooDifferent > 0) ||
-        (conflicts    > 0)) {
-      nBubbleConflict++;
-      continue;
-    }
+  //  This rule is possible too aggressive.  It was originally used before CHECK_OVERLAPS existed.
+  //  That should catch what 'self' and 'matedcont' were trying to catch.
+  if ((spurs        > 0) ||
+      (self         > 6) ||
+      (matedcont    > 6) ||
+      (diffOrient   > 0) ||
+      (tooLong      > 0) ||
+      (tigLong      > 0) ||
+      (tigShort     > 0) ||
+      (tooDifferent > 0) ||
+      (conflicts    > 0)) {
+    ev.verdict = BUBBLE_CONFLICT;
+    return;
+  }
 #else
-    //  The revised rule hasn't been tested though.
-    if ((spurs        > 0) ||
-        (diffOrient   > 0) ||
-        (tooLong      > 0) ||
-        (tigLong      > 0) ||
-        (tigShort     > 0) ||
-        (tooDifferent > 0) ||
-        (conflicts    > 0)) {
-      nBubbleConflict++;
-      continue;
-    }
+  //  The revised rule hasn't been tested though.
+  if ((spurs        > 0) ||
+      (diffOrient   > 0) ||
+      (tooLong      > 0) ||
+      (tigLong      > 0) ||
+      (tigShort     > 0) ||
+      (tooDifferent > 0) ||
+      (conflicts    > 0)) {
+    ev.verdict = BUBBLE_CONFLICT;
+    return;
+  }
 #endif
 
-    if (mergeTig == NULL)
-      //  Didn't find any place to put this short unitig.  It's not a bubble, just a short unitig
-      //  with no overlaps anywhere.
-      continue;
+  if (mergeTig == NULL)
+    //  Didn't find any place to put this short unitig.  It's not a bubble, just a short unitig
+    //  with no overlaps anywhere.
+    return;
 
-    //
-    //  Grab the overlaps for this read, paint the number of times we overlap some fragment
-    //  already in this unitig.  If we have any significant blocks with no coverage, the bubble
-    //  is probably too big for consensus.
-    //
+  ev.verdict   = BUBBLE_CANDIDATE;
+  ev.mergeID   = mergeTig->id();
+  ev.minNewPos = minNewPos;
+  ev.maxNewPos = maxNewPos;
+}
 
-#define CHECK_OVERLAPS
-#ifdef CHECK_OVERLAPS
-    for (int fi=0; fi<shortTig->dovetail_path_ptr->size(); fi++) {
-      DoveTailNode *frg = &(*shortTig->dovetail_path_ptr)[fi];
 
-      int32  frgID = frg->ident;
-      int32  utgID = shortTig->id();
 
-      BestEdgeOverlap *bestedge5 = bog_ptr->getBestEdgeOverlap(frg->ident, FIVE_PRIME);
-      BestEdgeOverlap *bestedge3 = bog_ptr->getBestEdgeOverlap(frg->ident, THREE_PRIME);
-      BestContainment *bestcont  = bog_ptr->getBestContainer(frg->ident);
+//  The second half of the test for a bubble, for a BUBBLE_CANDIDATE from placeBubble().
+//
+//  Grab the overlaps for each read, paint the number of times we overlap some fragment
+//  already in the merge unitig.  If we have any significant blocks with no coverage, the bubble
+//  is probably too big for consensus; the verdict is BUBBLE_TOOBIG, otherwise BUBBLE_POP.
+//
+//  ovlCnt is scratch space for AS_READ_MAX_NORMAL_LEN counts.
+//
+void
+UnitigGraph::checkBubble(Unitig *shortTig, BubbleOverlaps *ovls, uint32 *ovlCnt, BubbleEvaluation &ev) {
+  Unitig  *mergeTig     = (*unitigs)[ev.mergeID];
+  uint32   tooDifferent = 0;
 
-      if (bestcont)
-        continue;
+  int32    minNewPos    = ev.minNewPos;
+  int32    maxNewPos    = ev.maxNewPos;
 
-      ovlLen  = 0;
+  assert(ev.verdict == BUBBLE_CANDIDATE);
 
-      if (ovlStoreUniq) {
-        AS_OVS_setRangeOverlapStore(ovlStoreUniq, frgID, frgID);
-        ovlLen += AS_OVS_readOverlapsFromStore(ovlStoreUniq, ovl + ovlLen, ovlMax - ovlLen, AS_OVS_TYPE_ANY);
-      }
+#define CHECK_OVERLAPS
+#ifdef CHECK_OVERLAPS
+  for (int fi=0; fi<shortTig->dovetail_path_ptr->size(); fi++) {
+    DoveTailNode *frg = &(*shortTig->dovetail_path_ptr)[fi];
 
-      if (ovlStoreRept) {
-        AS_OVS_setRangeOverlapStore(ovlStoreRept, frgID, frgID);
-        ovlLen += AS_OVS_readOverlapsFromStore(ovlStoreRept, ovl + ovlLen, ovlMax - ovlLen, AS_OVS_TYPE_ANY);
-      }
+    int32  frgID = frg->ident;
+    int32  utgID = shortTig->id();
 
-      memset(ovlCnt, 0, sizeof(uint32) * AS_READ_MAX_NORMAL_LEN);
+    BestContainment *bestcont  = bog_ptr->getBestContainer(frg->ident);
 
-      uint32 alen = _fi->fragmentLength(frgID);
+    if (bestcont)
+      continue;
 
-      for (uint32 o=0; o<ovlLen; o++) {
-        int32 a_iid = ovl[o].a_iid;
-        int32 b_iid = ovl[o].b_iid;
+    BubbleOverlap *ovl    = NULL;
+    uint32         ovlLen = 0;
 
-        assert(a_iid == frgID);
+    ovls->get(frgID, ovl, ovlLen);
 
-        if (shortTig->fragIn(b_iid) != mergeTig->id())
-          //  Ignore overlaps to fragments not in this unitig.  We might want to ignore overlaps
-          //  to fragments in this unitig but not at this position, though that assumes we
-          //  actually got the placement correct....and it only matters for repeats.
-          continue;
+    memset(ovlCnt, 0, sizeof(uint32) * AS_READ_MAX_NORMAL_LEN);
 
-        uint32        mrgPos = mergeTig->pathPosition(b_iid);
-        DoveTailNode *mrg    = &(*mergeTig->dovetail_path_ptr)[mrgPos];
+    uint32 alen = _fi->fragmentLength(frgID);
 
-        if ((mrg->position.bgn < minNewPos - AS_OVERLAP_MIN_LEN) &&
-            (mrg->position.end < minNewPos - AS_OVERLAP_MIN_LEN)) {
-          //  This overlapping fragment is before the position we are supposed to be merging to, skip it.
-          fprintf(stderr, "frag %d ignores overlap to frag %d - outside range\n", frgID, b_iid);
-          continue;
-        }
+    for (uint32 o=0; o<ovlLen; o++) {
+      int32 b_iid = ovl[o].b_iid;
 
-        if ((mrg->position.bgn > maxNewPos - AS_OVERLAP_MIN_LEN) &&
-            (mrg->position.end > maxNewPos - AS_OVERLAP_MIN_LEN)) {
-          //  This overlapping fragment is after the position we are supposed to be merging to, skip it.
-          fprintf(stderr, "frag %d ignores overlap to frag %d - outside range\n", frgID, b_iid);
-          continue;
-        }
+      if (shortTig->fragIn(b_iid) != mergeTig->id())
+        //  Ignore overlaps to fragments not in this unitig.  We might want to ignore overlaps
+        //  to fragments in this unitig but not at this position, though that assumes we
+        //  actually got the placement correct....and it only matters for repeats.
+        continue;
 
-        uint32 bgn = 0;
-        uint32 end = 0;
+      uint32        mrgPos = mergeTig->pathPosition(b_iid);
+      DoveTailNode *mrg    = &(*mergeTig->dovetail_path_ptr)[mrgPos];
 
-        int32 a_hang = ovl[o].dat.ovl.a_hang;
-        int32 b_hang = ovl[o].dat.ovl.b_hang;
+      if ((mrg->position.bgn < minNewPos - AS_OVERLAP_MIN_LEN) &&
+          (mrg->position.end < minNewPos - AS_OVERLAP_MIN_LEN)) {
+        //  This overlapping fragment is before the position we are supposed to be merging to, skip it.
+        bubbleLog(ev.log, "frag %d ignores overlap to frag %d - outside range\n", frgID, b_iid);
+        continue;
+      }
 
-        if (a_hang < 0) {
-          //  b_hang < 0      ?     ----------  :     ----
-          //                  ?  ----------     :  ----------
-          //
-          bgn = 0;
-          end = (b_hang < 0) ? (alen + b_hang) : (alen);
-        } else {
-          //  b_hang < 0      ?  ----------              :  ----------
-          //                  ?     ----                 :     ----------
-          //
-          bgn = a_hang;
-          end = (b_hang < 0) ? (alen + b_hang) : alen;
-        }
+      if ((mrg->position.bgn > maxNewPos - AS_OVERLAP_MIN_LEN) &&
+          (mrg->position.end > maxNewPos - AS_OVERLAP_MIN_LEN)) {
+        //  This overlapping fragment is after the position we are supposed to be merging to, skip it.
+        bubbleLog(ev.log, "frag %d ignores overlap to frag %d - outside range\n", frgID, b_iid);
+        continue;
+      }
+
+      uint32 bgn = 0;
+      uint32 end = 0;
+
+      int32 a_hang = ovl[o].a_hang;
+      int32 b_hang = ovl[o].b_hang;
 
-        for (uint32 x=bgn; x<end; x++)
-          ovlCnt[x]++;
+      if (a_hang < 0) {
+        //  b_hang < 0      ?     ----------  :     ----
+        //                  ?  ----------     :  ----------
+        //
+        bgn = 0;
+        end = (b_hang < 0) ? (alen + b_hang) : (alen);
+      } else {
+        //  b_hang < 0      ?  ----------              :  ----------
+        //                  ?     ----                 :     ----------
+        //
+        bgn = a_hang;
+        end = (b_hang < 0) ? (alen + b_hang) : alen;
       }
 
-      //  Score the overlap coverage.  Allow a small amount of total zero, but don't
-      //  allow any significant blocks of zero.
+      for (uint32 x=bgn; x<end; x++)
+        ovlCnt[x]++;
+    }
 
-      uint32 zTotal    = 0;
-      uint32 zInternal = 0;
-      uint32 zSum      = 0;
+    //  Score the overlap coverage.  Allow a small amount of total zero, but don't
+    //  allow any significant blocks of zero.
 
-      for (uint32 x=0; x<alen; x++) {
-        if (ovlCnt[x] == 0) {
-          zTotal++;
-          zSum++;
-        } else {
-          if (zSum > zInternal)
-            zInternal = zSum;
-          zSum = 0;
-        }
+    uint32 zTotal    = 0;
+    uint32 zInternal = 0;
+    uint32 zSum      = 0;
+
+    for (uint32 x=0; x<alen; x++) {
+      if (ovlCnt[x] == 0) {
+        zTotal++;
+        zSum++;
+      } else {
+        if (zSum > zInternal)
+          zInternal = zSum;
+        zSum = 0;
       }
+    }
 
-      if ((zTotal > 0.10 * alen) ||
-          (zInternal > AS_OVERLAP_MIN_LEN))
-        tooDifferent++;
+    if ((zTotal > 0.10 * alen) ||
+        (zInternal > AS_OVERLAP_MIN_LEN))
+      tooDifferent++;
 
 #ifdef DEBUG_MERGE
-      if ((zTotal > 0) || (zInternal > 0)) {
-        fprintf(stderr, "frag %d too different with zTotal=%d (limit=%d) and zInternal=%d (ovl=%d)\n",
+    if ((zTotal > 0) || (zInternal > 0)) {
+      bubbleLog(ev.log, "frag %d too different with zTotal=%d (limit=%d) and zInternal=%d (ovl=%d)\n",
                 frgID, zTotal, (int)(0.10 * alen), zInternal, AS_OVERLAP_MIN_LEN);
-        for (uint32 x=0; x<alen; x++)
-          fprintf(stderr, "%c", (ovlCnt[x] < 10) ? '0' + ovlCnt[x] : '*');
-        fprintf(stderr, "\n");
-      }
+      for (uint32 x=0; x<alen; x++)
+        bubbleLog(ev.log, "%c", (ovlCnt[x] < 10) ? '0' + ovlCnt[x] : '*');
+      bubbleLog(ev.log, "\n");
+    }
 #endif
-    }  //  over all frags
+  }  //  over all frags
 
-    //  If there are fragments with missing overlaps, don't merge.
+  //  If there are fragments with missing overlaps, don't merge.
 
 #ifdef DEBUG_MERGE
-    fprintf(stderr, "popBubbles()-- unitig %d tooDifferent %d\n",
+  bubbleLog(ev.log, "popBubbles()-- unitig %d tooDifferent %d\n",
             shortTig->id(), tooDifferent);
 #endif
+#endif // CHECK_OVERLAPS
 
-    if (tooDifferent > 0) {
-      nBubbleTooBig++;
+  ev.verdict = (tooDifferent > 0) ? BUBBLE_TOOBIG : BUBBLE_POP;
+}
+
+
+
+//  Evaluates bubbles on threads; each thread takes the next few unitigs.
+//
+class BubbleBatch {
+public:
+  UnitigGraph        *ug;
+  vector<uint32>     *tigs;      //  candidate unitigs, in order
+  BubbleEvaluation   *evs;       //  evs[i] is the verdict for tigs[i]
+  BubbleOverlaps     *ovls;      //  NULL: place; otherwise: check candidates
+  uint32              next;
+  pthread_mutex_t     mutex;
+};
+
+
+static
+void
+bubbleBatchRange(BubbleBatch *b, uint32 bgn, uint32 end, uint32 *ovlCnt) {
+  for (uint32 i=bgn; i<end; i++) {
+    Unitig *shortTig = (*b->ug->unitigs)[(*b->tigs)[i]];
+
+    if (b->ovls == NULL)
+      b->ug->placeBubble(shortTig, b->evs[i]);
+    else if (b->evs[i].verdict == BUBBLE_CANDIDATE)
+      b->ug->checkBubble(shortTig, b->ovls, ovlCnt, b->evs[i]);
+  }
+}
+
+
+static
+void *
+bubbleBatchThread(void *arg) {
+  BubbleBatch  *b      = (BubbleBatch *)arg;
+  uint32       *ovlCnt = new uint32 [AS_READ_MAX_NORMAL_LEN];
+
+  while (1) {
+    pthread_mutex_lock(&b->mutex);
+    uint32  bgn = b->next;
+    uint32  end = MIN(bgn + 16, b->tigs->size());
+    b->next = end;
+    pthread_mutex_unlock(&b->mutex);
+
+    if (bgn >= b->tigs->size())
+      break;
+
+    bubbleBatchRange(b, bgn, end, ovlCnt);
+  }
+
+  delete [] ovlCnt;
+
+  return(NULL);
+}
+
+
+static
+void
+bubbleBatchRun(BubbleBatch *b, uint32 numThreads) {
+
+  b->next = 0;
+
+  if (numThreads <= 1) {
+    uint32 *ovlCnt = new uint32 [AS_READ_MAX_NORMAL_LEN];
+    bubbleBatchRange(b, 0, b->tigs->size(), ovlCnt);
+    delete [] ovlCnt;
+    return;
+  }
+
+  pthread_mutex_init(&b->mutex, NULL);
+
+  pthread_t  *tid = new pthread_t [numThreads];
+
+  for (uint32 t=0; t<numThreads; t++) {
+    int err = pthread_create(tid + t, NULL, bubbleBatchThread, b);
+    if (err)
+      fprintf(stderr, "popBubbles()-- failed to create thread: %s\n", strerror(err)), exit(1);
+  }
+
+  for (uint32 t=0; t<numThreads; t++)
+    pthread_join(tid[t], NULL);
+
+  pthread_mutex_destroy(&b->mutex);
+
+  delete [] tid;
+}
+
+
+
+//  Sometimes, we don't include fragments into a unitig, even though the best overlap off of both
+//  ends is to the same unitig.  This will include those.
+//
+//  Every short unitig is first evaluated against the unitigs as they are now, on _numThreads
+//  threads.  Merges are then made in unitig order, exactly as if each unitig was evaluated just
+//  before its turn: a verdict that looked at a unitig changed by an earlier merge is recomputed.
+//
+void
+UnitigGraph::popBubbles(OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept) {
+
+  uint32      nBubblePopped   = 0;
+  uint32      nBubbleTooBig   = 0;
+  uint32      nBubbleConflict = 0;
+
+  fprintf(stderr, "==> SEARCHING FOR BUBBLES\n");
+
+  vector<uint32>      tigs;
+
+  for (uint32 ti=0; ti<unitigs->size(); ti++) {
+    Unitig *shortTig = (*unitigs)[ti];
+
+    if ((shortTig == NULL) ||
+        (shortTig->dovetail_path_ptr == NULL) ||
+        (shortTig->dovetail_path_ptr->size() >= 30))
       continue;
+
+    tigs.push_back(ti);
+  }
+
+  BubbleEvaluation   *evs  = new BubbleEvaluation [tigs.size()];
+  BubbleOverlaps      ovls(ovlStoreUniq, ovlStoreRept);
+  BubbleBatch         batch;
+
+  batch.ug   = this;
+  batch.tigs = &tigs;
+  batch.evs  = evs;
+  batch.ovls = NULL;
+
+  bubbleBatchRun(&batch, _numThreads);
+
+  //  Load overlaps for the non-contained fragments of every candidate, then check them.
+
+  {
+    vector<uint32>  frags;
+
+    for (uint32 i=0; i<tigs.size(); i++) {
+      if (evs[i].verdict != BUBBLE_CANDIDATE)
+        continue;
+
+      DoveTailPath *path = (*unitigs)[tigs[i]]->dovetail_path_ptr;
+
+      for (uint32 fi=0; fi<path->size(); fi++)
+        if (bog_ptr->getBestContainer((*path)[fi].ident) == NULL)
+          frags.push_back((*path)[fi].ident);
     }
-#endif // CHECK_OVERLAPS
 
+    ovls.load(frags);
+  }
+
+  batch.ovls = &ovls;
+
+  bubbleBatchRun(&batch, _numThreads);
+
+  //  Merge, in order.
+
+  vector<bool>   merged(unitigs->size(), false);
+  uint32        *ovlCnt = new uint32 [AS_READ_MAX_NORMAL_LEN];
+
+  for (uint32 i=0; i<tigs.size(); i++) {
+    uint32            ti = tigs[i];
+    BubbleEvaluation &ev = evs[i];
+    bool              stale = false;
+
+    for (uint32 r=0; r<ev.readTigs.size(); r++)
+      if (merged[ev.readTigs[r]])
+        stale = true;
+
+    if (stale) {
+      placeBubble((*unitigs)[ti], ev);
+
+      if (ev.verdict == BUBBLE_CANDIDATE)
+        checkBubble((*unitigs)[ti], &ovls, ovlCnt, ev);
+    }
+
+    fputs(ev.log.c_str(), stderr);
+
+    if (ev.verdict == BUBBLE_CONFLICT)
+      nBubbleConflict++;
+
+    if (ev.verdict == BUBBLE_TOOBIG)
+      nBubbleTooBig++;
+
+    if (ev.verdict != BUBBLE_POP)
+      continue;
+
+    Unitig  *shortTig = (*unitigs)[ti];
+    Unitig  *mergeTig = (*unitigs)[ev.mergeID];
+
+    merged[shortTig->id()] = true;
+    merged[mergeTig->id()] = true;
 
     //  Merge this unitig into otherUtg.
 
@@ -1746,8 +2424,8 @@ UnitigGraph::popBubbles(OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept)
     }
   }  //  over all unitigs
 
-  delete [] ovl;
   delete [] ovlCnt;
+  delete [] evs;
 
   fprintf(stderr, "==> SEARCHING FOR BUBBLES done, %u popped, %u had conflicting placement, %u were too dissimilar.\n",
           nBubblePopped, nBubbleConflict, nBubbleTooBig);
@@ -1755,8 +2433,6 @@ UnitigGraph::popBubbles(OverlapStore *ovlStoreUniq, OverlapStore *ovlStoreRept)
 
 
 
-
-
 float UnitigGraph::getGlobalArrivalRate(long total_random_frags_in_genome, long genome_size){
 
   float _globalArrivalRate;
@@ -1769,120 +2445,64 @@ float UnitigGraph::getGlobalArrivalRate(long total_random_frags_in_genome, long
     size_t rho_gt_10000 = 0;
 
     // Go through all the unitigs to sum rho and unitig arrival frags
-    UnitigVector::const_iterator iter;
-    for(
-        iter=unitigs->begin();
-        iter!=unitigs->end();
-        iter++){
+    for (uint32 ti=0; ti<unitigs->size(); ti++) {
+      Unitig  *utg = (*unitigs)[ti];
 
-      if (*iter == NULL)
+      if (utg == NULL)
         continue;
 
-      avg_rho = (*iter)->getAvgRho(_fi);
+      avg_rho = utg->getAvgRho(_fi);
       total_rho += avg_rho;
-      if (avg_rho > 10000.0)
-        rho_gt_10000 += (size_t)avg_rho / 10000;
+      rho_gt_10000 += AS_UTL_numArrivalRateSamples(avg_rho);
 
-      float unitig_random_frags = (*iter)->getNumRandomFrags();
+      long  numRandom = utg->getNumRandomFrags(_fi);
+
+      float unitig_random_frags = numRandom;
       if (--unitig_random_frags < 0)
         unitig_random_frags = 0;
 
       total_arrival_frags += unitig_random_frags;
-      (*iter)->setLocalArrivalRate( unitig_random_frags / avg_rho );
+      utg->setLocalArrivalRate(AS_UTL_localArrivalRate(avg_rho, numRandom));
     }
+
     // Estimate GAR
     _globalArrivalRate = (total_rho > 0) ? (total_arrival_frags / total_rho): 0;
 
     std::cerr << "Calculated Global Arrival rate " << _globalArrivalRate <<
       std::endl;
-    // Now recalculate based on big unitigs, copied from AS_CGB/AS_CGB_cgb.c
-    if (rho_gt_10000 * 20000 > total_rho) {
-      float min_10_local_arrival_rate          = _globalArrivalRate;
-      float median_local_arrival_rate          = _globalArrivalRate;
-      float max_local_arrival_rate             = _globalArrivalRate;
-      float recalibrated_fragment_arrival_rate = _globalArrivalRate;
-      size_t num_arrival_rates=0;
-      int median_index;
-      std::vector<float> arrival_rate_array(rho_gt_10000);
-
-      for( iter=unitigs->begin(); iter!=unitigs->end(); iter++) {
-        if (*iter == NULL)
+
+    // Now recalculate based on big unitigs, as in AS_CGB/AS_CGB_cgb.C, except that the samples
+    // are n/rho, not (n-1)/rho.
+    if (rho_gt_10000 > 0) {
+      float  *samples    = new float [rho_gt_10000];
+      size_t  samplesLen = 0;
+
+      for (uint32 ti=0; ti<unitigs->size(); ti++) {
+        Unitig  *utg = (*unitigs)[ti];
+
+        if (utg == NULL)
           continue;
-        avg_rho = (*iter)->getAvgRho(_fi);
-        if (avg_rho > 10000.0) {
-          const int num_10000 = (size_t)avg_rho / 10000;
-          const float local_arrival_rate =
-            (*iter)->getNumRandomFrags() / avg_rho;
-          assert(num_10000 > 0);
-          int i;
-          for(i=0;i<num_10000;i++){
-            assert(i < rho_gt_10000);
-            arrival_rate_array[i] = local_arrival_rate;
-            num_arrival_rates++;
-          }
-          if(num_arrival_rates > 0){
-            float tmp_fragment_arrival_rate, max_diff_arrival_rate;
-            float prev_arrival_rate, cur_arrival_rate, diff_arrival_rate;
-            int max_diff_index;
-            std::sort(arrival_rate_array.begin(),arrival_rate_array.end());
-            min_10_local_arrival_rate = arrival_rate_array[num_arrival_rates / 10];
-            median_index = (num_arrival_rates * 5) / 10;
-            median_local_arrival_rate = arrival_rate_array[median_index];
-            max_local_arrival_rate = arrival_rate_array[num_arrival_rates-1];
-            recalibrated_fragment_arrival_rate =
-              arrival_rate_array[(num_arrival_rates * 19) / 20];
-            prev_arrival_rate = min_10_local_arrival_rate;
-            max_diff_arrival_rate = 0.0;
-            for(i=num_arrival_rates / 10;i<median_index;i++){
-              cur_arrival_rate = arrival_rate_array[i];
-              diff_arrival_rate = cur_arrival_rate - prev_arrival_rate;
-              prev_arrival_rate = cur_arrival_rate;
-              if(diff_arrival_rate > max_diff_arrival_rate){
-                max_diff_arrival_rate = diff_arrival_rate;
-              }
-            }
-            max_diff_arrival_rate *= 2.0;
-            max_diff_index = num_arrival_rates - 1;
-            for(i=median_index;i<num_arrival_rates;i++){
-              cur_arrival_rate = arrival_rate_array[i];
-              diff_arrival_rate = cur_arrival_rate - prev_arrival_rate;
-              prev_arrival_rate = cur_arrival_rate;
-              if(diff_arrival_rate > max_diff_arrival_rate){
-                max_diff_arrival_rate = diff_arrival_rate;
-                max_diff_index = i - 1;
-                break;
-              }
-            }
-            max_diff_arrival_rate = arrival_rate_array[max_diff_index];
-            tmp_fragment_arrival_rate =MIN(min_10_local_arrival_rate * 2.0,
-                                           median_local_arrival_rate * 1.25);
-            if(tmp_fragment_arrival_rate < recalibrated_fragment_arrival_rate){
-              recalibrated_fragment_arrival_rate = tmp_fragment_arrival_rate;
-            }
-            if(max_diff_arrival_rate < recalibrated_fragment_arrival_rate){
-              recalibrated_fragment_arrival_rate = max_diff_arrival_rate;
-            }
-          }
-          if(recalibrated_fragment_arrival_rate > _globalArrivalRate){
-            _globalArrivalRate = recalibrated_fragment_arrival_rate;
-#if 0
-            std::cerr <<
-              "Used recalibrated global_fragment_arrival_rate="
-                      << _globalArrivalRate << std::endl
-                      << "Used recalibrated global_fragment_arrival_distance="
-                      <<((_globalArrivalRate > 0.) ? 1./(_globalArrivalRate) : 0.)
-                      << std::endl
-                      << "Chunk arrival rates sorted at 1/100s"
-                      << std::endl ;
-            for(i=0;i<100;i++) {
-              std::cerr<<arrival_rate_array[((num_arrival_rates * i) / 100)]
-                       << std::endl;
-            }
-            std::cerr << max_local_arrival_rate << std::endl;
-#endif
-          }
-        }
+
+        avg_rho = utg->getAvgRho(_fi);
+
+        size_t num_10000 = AS_UTL_numArrivalRateSamples(avg_rho);
+
+        if (num_10000 == 0)
+          continue;
+
+        const float local_arrival_rate = utg->getNumRandomFrags(_fi) / avg_rho;
+
+        for (size_t i=0; i<num_10000; i++)
+          samples[samplesLen++] = local_arrival_rate;
       }
+      assert(samplesLen == rho_gt_10000);
+
+      float recalibrated = AS_UTL_recalibrateArrivalRate(_globalArrivalRate, total_rho, samples, samplesLen);
+
+      if (recalibrated > _globalArrivalRate)
+        _globalArrivalRate = recalibrated;
+
+      delete [] samples;
     }
 
     std::cerr << 
@@ -2313,6 +2933,124 @@ UnitigVector* UnitigGraph::breakUnitigAt(ContainerMap &cMap,
 
 
 
+//  Unitigs are converted to MultiAlignT, and their lines in the iidmap and partitioning files are
+//  formatted, this many at a time on threads.  They're then written in order.
+//
+#define IUM_BATCH  4096
+
+class IUMBatch {
+public:
+  UnitigGraph       *ug;
+  FragmentInfo      *fi;
+
+  uint32            *tigs;       //  unitig index for each slot
+  uint32            *iumiid;     //  IUM id for each slot
+  uint32            *partmap;    //  partition for each IUM id
+
+  MultiAlignT      **ma;
+  string            *iidmLines;
+  string            *partLines;
+
+  uint32             len;
+  uint32             next;
+  pthread_mutex_t    mutex;
+};
+
+
+static
+void
+IUMBatchConvert(IUMBatch *b, uint32 i) {
+  Unitig       *utg = (*b->ug->unitigs)[b->tigs[i]];
+  uint32        nf  = utg->getNumFrags();
+  uint32        pp  = b->partmap[b->iumiid[i]];
+  MultiAlignT  *ma  = b->ma[i];
+  char          line[256];
+
+  sprintf(line, "Unitig " F_U32" == IUM " F_U32" (in partition " F_U32" with " F_S64" frags)\n",
+          utg->id(), b->iumiid[i], pp, nf);
+
+  b->iidmLines[i].assign(line);
+  b->partLines[i].clear();
+
+  for (int32 fragIdx=0; fragIdx<nf; fragIdx++) {
+    DoveTailNode  *f = &(*utg->dovetail_path_ptr)[fragIdx];
+
+    sprintf(line, "%d\t%d\n", pp, f->ident);
+    b->partLines[i].append(line);
+
+    //  We abused the delta_length field earlier.  Make sure it's sane.  If not, we assert when
+    //  writing the tig.
+    f->delta_length = 0;
+#ifdef WITHIMP
+    f->delta        = NULL;
+#endif
+  }
+
+  //  Massage the Unitig into a MultiAlignT (also used in SplitChunks_CGW.c)
+
+  ma->maID                      = b->iumiid[i];
+  ma->data.unitig_coverage_stat = utg->getCovStat(b->fi);
+  ma->data.unitig_microhet_prob = 1.0;  //  Default to 100% probability of unique
+
+  ma->data.unitig_status        = AS_UNASSIGNED;
+  ma->data.unitig_unique_rept   = AS_FORCED_NONE;
+
+  ma->data.contig_status        = AS_UNPLACED;
+
+  //  Add the fragments
+
+  ResetVA_IntMultiPos(ma->f_list);
+#ifdef WITHIMP
+  SetRangeVA_IntMultiPos(ma->f_list, 0, nf, &(*utg->dovetail_path_ptr)[0]);
+#else
+  for (uint32 fi=0; fi<utg->dovetail_path_ptr->size(); fi++) {
+    DoveTailNode  *frg = &(*utg->dovetail_path_ptr)[fi];
+    IntMultiPos    imp;
+
+    imp.type         = AS_READ;
+    imp.ident        = frg->ident;
+    imp.contained    = frg->contained;
+    imp.parent       = frg->parent;
+    imp.ahang        = frg->ahang;
+    imp.bhang        = frg->bhang;
+    imp.position.bgn = frg->position.bgn;
+    imp.position.end = frg->position.end;
+    imp.delta_length = 0;
+    imp.delta        = NULL;
+
+    AppendVA_IntMultiPos(ma->f_list, &imp);
+  }
+#endif
+
+  //  NOTE!  This is not currently a valid multialign as it has NO IntUnitigPos.  That is
+  //  added during consensus.  CGW will correctly assert that it reads in unitigs with
+  //  exactly one IUP.
+}
+
+
+static
+void *
+IUMBatchThread(void *arg) {
+  IUMBatch  *b = (IUMBatch *)arg;
+
+  while (1) {
+    pthread_mutex_lock(&b->mutex);
+    uint32  bgn = b->next;
+    uint32  end = MIN(bgn + 16, b->len);
+    b->next = end;
+    pthread_mutex_unlock(&b->mutex);
+
+    if (bgn >= b->len)
+      break;
+
+    for (uint32 i=bgn; i<end; i++)
+      IUMBatchConvert(b, i);
+  }
+
+  return(NULL);
+}
+
+
 void UnitigGraph::writeIUMtoFile(char *fileprefix, char *tigStorePath, int frg_count_target){
   int32       utg_count              = 0;
   int32       frg_count              = 0;
@@ -2338,7 +3076,7 @@ void UnitigGraph::writeIUMtoFile(char *fileprefix, char *tigStorePath, int frg_c
   FILE *pari = fopen(filename, "w");
   assert(NULL != pari);
 
-  //  Step through all the unitigs once to build the partition mapping and IID mapping.
+  //  Step through all the unitigs once to build the partition mapping.
 
   for (uint32 iumiid=0, ti=0; ti<unitigs->size(); ti++) {
     Unitig  *utg = (*unitigs)[ti];
@@ -2363,22 +3101,6 @@ void UnitigGraph::writeIUMtoFile(char *fileprefix, char *tigStorePath, int frg_c
 
     partmap[iumiid] = prt_count;
 
-    fprintf(iidm, "Unitig " F_U32" == IUM " F_U32" (in partition " F_U32" with " F_S64" frags)\n",
-            utg->id(), iumiid, partmap[iumiid], nf);
-
-    for (int32 fragIdx=0; fragIdx<nf; fragIdx++) {
-      DoveTailNode  *f = &(*utg->dovetail_path_ptr)[fragIdx];
-
-      fprintf(part, "%d\t%d\n", prt_count, f->ident);
-
-      //  We abused the delta_length field earlier.  Make sure it's sane.  If not, we assert when
-      //  writing the tig.
-      f->delta_length = 0;
-#ifdef WITHIMP
-      f->delta        = NULL;
-#endif
-    }
-
     utg_count += 1;
     frg_count += nf;
 
@@ -2389,70 +3111,89 @@ void UnitigGraph::writeIUMtoFile(char *fileprefix, char *tigStorePath, int frg_c
           prt_count, utg_count, frg_count);
 
   fclose(pari);
-  fclose(part);
-  fclose(iidm);
 
-  //  Step through all the unitigs once to build the partition mapping and IID mapping.
+  //  Step through all the unitigs again, converting a batch on threads, then writing the
+  //  IID mapping, the partitioning and the tig store, in order.
 
   MultiAlignStore  *MAS = new MultiAlignStore(tigStorePath);
-  MultiAlignT      *ma  = CreateEmptyMultiAlignT();
 
   MAS->writeToPartitioned(partmap, NULL);
 
-  for (uint32 iumiid=0, ti=0; ti<unitigs->size(); ti++) {
-    Unitig  *utg = (*unitigs)[ti];
-    uint32   nf  = (utg) ? utg->getNumFrags() : 0;
-
-    if ((utg == NULL) || (nf == 0))
-      continue;
+  IUMBatch   b;
 
-    //  Massage the Unitig into a MultiAlignT (also used in SplitChunks_CGW.c)
+  b.ug        = this;
+  b.fi        = _fi;
+  b.tigs      = new uint32        [IUM_BATCH];
+  b.iumiid    = new uint32        [IUM_BATCH];
+  b.partmap   = partmap;
+  b.ma        = new MultiAlignT * [IUM_BATCH];
+  b.iidmLines = new string        [IUM_BATCH];
+  b.partLines = new string        [IUM_BATCH];
+  b.len       = 0;
 
-    ma->maID                      = iumiid;
-    ma->data.unitig_coverage_stat = utg->getCovStat(_fi);
-    ma->data.unitig_microhet_prob = 1.0;  //  Default to 100% probability of unique
+  for (uint32 i=0; i<IUM_BATCH; i++)
+    b.ma[i] = CreateEmptyMultiAlignT();
 
-    ma->data.unitig_status        = AS_UNASSIGNED;
-    ma->data.unitig_unique_rept   = AS_FORCED_NONE;
+  for (uint32 iumiid=0, ti=0; ti<unitigs->size(); ) {
 
-    ma->data.contig_status        = AS_UNPLACED;
+    for (b.len=0; (b.len < IUM_BATCH) && (ti < unitigs->size()); ti++) {
+      Unitig  *utg = (*unitigs)[ti];
 
-    //  Add the fragments
+      if ((utg == NULL) || (utg->getNumFrags() == 0))
+        continue;
 
-    ResetVA_IntMultiPos(ma->f_list);
-#ifdef WITHIMP
-    SetRangeVA_IntMultiPos(ma->f_list, 0, nf, &(*utg->dovetail_path_ptr)[0]);
-#else
-    for (uint32 fi=0; fi<utg->dovetail_path_ptr->size(); fi++) {
-      DoveTailNode  *frg = &(*utg->dovetail_path_ptr)[fi];
-      IntMultiPos    imp;
-
-      imp.type         = AS_READ;
-      imp.ident        = frg->ident;
-      imp.contained    = frg->contained;
-      imp.parent       = frg->parent;
-      imp.ahang        = frg->ahang;
-      imp.bhang        = frg->bhang;
-      imp.position.bgn = frg->position.bgn;
-      imp.position.end = frg->position.end;
-      imp.delta_length = 0;
-      imp.delta        = NULL;
-
-      AppendVA_IntMultiPos(ma->f_list, &imp);
+      b.tigs[b.len]   = ti;
+      b.iumiid[b.len] = iumiid++;
+      b.len++;
     }
-#endif
 
-    //  NOTE!  This is not currently a valid multialign as it has NO IntUnitigPos.  That is
-    //  added during consensus.  CGW will correctly assert that it reads in unitigs with
-    //  exactly one IUP.
+    b.next = 0;
 
-    //  Stash the unitig in the store
+    if (_numThreads <= 1) {
+      for (uint32 i=0; i<b.len; i++)
+        IUMBatchConvert(&b, i);
 
-    MAS->insertMultiAlign(ma, TRUE, FALSE);
+    } else {
+      pthread_t  *tid = new pthread_t [_numThreads];
 
-    iumiid++;
+      pthread_mutex_init(&b.mutex, NULL);
+
+      for (uint32 t=0; t<_numThreads; t++) {
+        int err = pthread_create(tid + t, NULL, IUMBatchThread, &b);
+        if (err)
+          fprintf(stderr, "writeIUMtoFile()-- failed to create thread: %s\n", strerror(err)), exit(1);
+      }
+
+      for (uint32 t=0; t<_numThreads; t++)
+        pthread_join(tid[t], NULL);
+
+      pthread_mutex_destroy(&b.mutex);
+
+      delete [] tid;
+    }
+
+    for (uint32 i=0; i<b.len; i++) {
+      fwrite(b.iidmLines[i].c_str(), sizeof(char), b.iidmLines[i].size(), iidm);
+      fwrite(b.partLines[i].c_str(), sizeof(char), b.partLines[i].size(), part);
+
+      //  Stash the unitig in the store
+
+      MAS->insertMultiAlign(b.ma[i], TRUE, FALSE);
+    }
   }
 
+  fclose(part);
+  fclose(iidm);
+
+  for (uint32 i=0; i<IUM_BATCH; i++)
+    DeleteMultiAlignT(b.ma[i]);
+
+  delete [] b.tigs;
+  delete [] b.iumiid;
+  delete [] b.ma;
+  delete [] b.iidmLines;
+  delete [] b.partLines;
+
   delete    MAS;
   delete [] partmap;
 }
@@ -24,6 +24,8 @@
 
 // static const char *rcsid_INCLUDE_AS_BOG_UNITIGGRAPH = "$Id: AS_BOG_UnitigGraph.hh,v 1.71 2010/04/26 04:11:59 brianwalenz Exp $";
 
+#include <string>
+
 #include "AS_BOG_Datatypes.hh"
 #include "AS_BOG_ChunkGraph.hh"
 #include "AS_BOG_Unitig.hh"
@@ -71,11 +73,33 @@ struct UnitigBreakPoint {
 typedef std::list<UnitigBreakPoint> UnitigBreakPoints;
 
 
+//  What popBubbles() decided about one short unitig.
+//
+enum BubbleVerdict {
+  BUBBLE_NONE,          //  no place to put it
+  BUBBLE_CONFLICT,      //  edges disagree on where to put it
+  BUBBLE_CANDIDATE,     //  placed, overlaps not checked yet
+  BUBBLE_TOOBIG,        //  placed, but too different for consensus
+  BUBBLE_POP            //  merge it into mergeID
+};
+
+struct BubbleEvaluation {
+  BubbleVerdict   verdict;
+  uint32          mergeID;
+  int32           minNewPos;
+  int32           maxNewPos;
+  vector<uint32>  readTigs;   //  unitigs the verdict depends on, sorted
+  string          log;        //  messages to print when the verdict is used
+};
+
+class BubbleOverlaps;
+struct UnitigWalk;
+
 
 struct UnitigGraph{   
   // This will store the entire set of unitigs that are generated
   // It's just a unitig container.
-  UnitigGraph(FragmentInfo *fi, BestOverlapGraph *);
+  UnitigGraph(FragmentInfo *fi, BestOverlapGraph *, uint32 numThreads=1);
   ~UnitigGraph();
 
   // Call this on a chunk graph pointer to build a unitig graph
@@ -99,6 +123,9 @@ struct UnitigGraph{
   void placeZombies(void);
   void popBubbles(OverlapStore *ovlStoreUniq,
                   OverlapStore *ovlStoreRept);
+  void walkUnitig(UnitigWalk *walk);
+  void placeBubble(Unitig *shortTig, BubbleEvaluation &ev);
+  void checkBubble(Unitig *shortTig, BubbleOverlaps *ovls, uint32 *ovlCnt, BubbleEvaluation &ev);
 
   void filterBreakPoints(ContainerMap &cMap,
                          Unitig *,
@@ -125,12 +152,22 @@ private:
   static const int MIN_BREAK_FRAGS = 1;
   static const int MIN_BREAK_LENGTH = 500;
 
-  void populateUnitig(int32               fragID);
+  void populateUnitigs(ChunkGraph        *cg_ptr);
+
+  void populateUnitig(int32               fragID,
+                      UnitigWalk         *walk=NULL);
 
   void populateUnitig(Unitig             *unitig,
-                      BestEdgeOverlap    *nextedge);
+                      BestEdgeOverlap    *nextedge,
+                      UnitigWalk         *walk=NULL);
+
+  void saveIntersection(uint32            invaded,
+                        uint32            invader,
+                        bool              isSelf,
+                        UnitigWalk       *walk);
 
   FragmentInfo     *_fi;
+  uint32            _numThreads;
 
   //  This is a map from 'invaded fragment' to a list of 'invading fragments';
   //    unitigIntersect[a] = b means that b is invading into a.
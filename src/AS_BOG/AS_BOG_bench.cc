@@ -0,0 +1,429 @@
+
+/**************************************************************************
+ * This file is part of Celera Assembler, a software program that
+ * assembles whole-genome shotgun reads into contigs and scaffolds.
+ * Copyright (C) 2010, J. Craig Venter Institute.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received (LICENSE.txt) a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *************************************************************************/
+
+const char *mainid = "$Id$";
+
+//  Memory and time of the in-core BOG fragment and containment tables on a
+//  synthetic graph, for the old layout (one array per fragment attribute,
+//  a heap allocated near-containment list per contained fragment, sorted
+//  lazily on lookup) and the current one (packed FragmentRecord, 16-byte
+//  BestContainment, all near-containment lists in one CSR array sorted
+//  once).
+//
+//  Both layouts are built from the same random stream and must answer
+//  every query identically.
+
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "AS_BOG_Datatypes.hh"
+
+
+static
+double
+getTime(void) {
+  struct timeval  tp;
+  gettimeofday(&tp, NULL);
+  return(tp.tv_sec + (double)tp.tv_usec / 1000000.0);
+}
+
+
+//  Resident set size in MB, or zero if we can't tell.
+static
+double
+getResidentMB(void) {
+  FILE    *F = fopen("/proc/self/statm", "r");
+  uint64   v = 0;
+  uint64   r = 0;
+
+  if (F == NULL)
+    return(0.0);
+
+  if (fscanf(F, F_U64 " " F_U64, &v, &r) != 2)
+    r = 0;
+
+  fclose(F);
+
+  return(r * (double)getpagesize() / 1048576.0);
+}
+
+
+
+//  The layout before the packed records.
+//
+class oldBestContainment {
+public:
+  oldBestContainment() {
+  };
+  ~oldBestContainment() {
+    delete [] olaps;
+  };
+
+  uint32  container:31;
+  uint32  isContained:1;
+
+  int32   a_hang;
+  int32   b_hang;
+
+  uint32  sameOrientation:1;
+  uint32  isPlaced:1;
+  uint32  olapsSorted:1;
+  uint32  olapsLen:29;
+  uint32 *olaps;
+};
+
+
+struct benchParams {
+  uint32   numReads;
+  double   containedFraction;
+  uint32   olapsPerContained;
+  uint32   numQueries;
+  uint32   seed;
+};
+
+
+//  Shared by both layouts, so they see exactly the same graph.  Like
+//  BestOverlapGraph, both make one pass to count the near-containment
+//  overlaps and a second to store them.
+static
+void
+makeRead(uint32 iid, benchParams &p, uint32 &fragLength, uint32 &mateIID, uint32 &libIID, uint32 &olapsLen) {
+  fragLength = 400 + lrand48() % 800;
+  mateIID    = ((iid & 1) && (iid < p.numReads)) ? iid + 1 : ((iid & 1) ? 0 : iid - 1);
+  libIID     = 1 + (iid % 7);
+  olapsLen   = (drand48() < p.containedFraction) ? (1 + lrand48() % (2 * p.olapsPerContained)) : 0;
+}
+
+static
+uint32
+makeOlap(uint32 iid, benchParams &p) {
+  uint32  o = iid + lrand48() % 2000;
+
+  if (o < 1000)
+    return(1);
+
+  o -= 1000;
+
+  return((o > p.numReads) ? p.numReads : o);
+}
+
+static
+void
+makeQuery(benchParams &p, uint32 &iid, uint32 &other) {
+  iid   = 1 + lrand48() % p.numReads;
+  other = makeOlap(iid, p);
+}
+
+
+
+static
+void
+benchOld(benchParams &p) {
+  double   rss0 = getResidentMB();
+  double   t0   = getTime();
+
+  uint32  *fragLength = new uint32 [p.numReads + 1];
+  uint32  *mateIID    = new uint32 [p.numReads + 1];
+  uint32  *libIID     = new uint32 [p.numReads + 1];
+
+  oldBestContainment  *bc = new oldBestContainment [p.numReads + 1]();
+
+  uint64   numOlaps = 0;
+
+  srand48(p.seed);
+
+  fragLength[0] = mateIID[0] = libIID[0] = 0;
+
+  for (uint32 i=1; i<=p.numReads; i++) {
+    uint32  len = 0;
+
+    makeRead(i, p, fragLength[i], mateIID[i], libIID[i], len);
+
+    if (len == 0)
+      continue;
+
+    bc[i].container   = i - 1;
+    bc[i].isContained = 1;
+    bc[i].olapsLen    = len;
+
+    for (uint32 j=0; j<len; j++)
+      makeOlap(i, p);
+
+    numOlaps += len;
+  }
+
+  srand48(p.seed);
+
+  for (uint32 i=1; i<=p.numReads; i++) {
+    uint32  a, b, c, len = 0;
+
+    makeRead(i, p, a, b, c, len);
+
+    if (len == 0)
+      continue;
+
+    bc[i].olaps = new uint32 [len];
+
+    for (uint32 j=0; j<len; j++)
+      bc[i].olaps[j] = makeOlap(i, p);
+  }
+
+  double   t1   = getTime();
+  double   rss1 = getResidentMB();
+
+  //  Queries.  Sorting is lazy, and happens here.
+
+  uint64   hits = 0;
+
+  for (uint32 q=0; q<p.numQueries; q++) {
+    uint32  i, o;
+
+    makeQuery(p, i, o);
+
+    oldBestContainment *c = bc + i;
+
+    if ((c->olapsLen == 0) || (c->olaps == NULL) || (c->isContained == false))
+      continue;
+
+    if (c->olapsLen < 16) {
+      for (uint32 j=0; j<c->olapsLen; j++)
+        if (c->olaps[j] == o) {
+          hits++;
+          break;
+        }
+    } else {
+      if (c->olapsSorted == false) {
+        std::sort(c->olaps, c->olaps + c->olapsLen);
+        c->olapsSorted = true;
+      }
+      if (std::binary_search(c->olaps, c->olaps + c->olapsLen, o))
+        hits++;
+    }
+  }
+
+  double   t2   = getTime();
+
+  uint64   sum = 0;
+
+  for (uint32 q=0; q<p.numQueries; q++) {
+    uint32  i, o;
+
+    makeQuery(p, i, o);
+
+    sum += libIID[i] + fragLength[mateIID[i]] + fragLength[o];
+  }
+
+  double   t3   = getTime();
+
+  delete [] bc;
+  delete [] fragLength;
+  delete [] mateIID;
+  delete [] libIID;
+
+  double   t4   = getTime();
+
+  fprintf(stdout, "old:  build %8.3fs  contains %8.3fs  frags %8.3fs  free %8.3fs  RSS %10.1f MB  (" F_U64" olaps, " F_U64" hits, sum " F_U64")\n",
+          t1 - t0, t2 - t1, t3 - t2, t4 - t3, rss1 - rss0, numOlaps, hits, sum);
+}
+
+
+
+static
+void
+benchNew(benchParams &p) {
+  double   rss0 = getResidentMB();
+  double   t0   = getTime();
+
+  FragmentRecord   *fr = new FragmentRecord  [p.numReads + 1];
+  BestContainment  *bc = new BestContainment [p.numReads + 1];
+  uint64           *ob = new uint64          [p.numReads + 2];
+
+  memset(fr, 0, sizeof(FragmentRecord)  * (p.numReads + 1));
+  memset(bc, 0, sizeof(BestContainment) * (p.numReads + 1));
+
+  //  Pass 1 counts into the begins, pass 2 fills using them as the
+  //  cursor, then they're shifted back.
+
+  uint64   numOlaps = 0;
+
+  srand48(p.seed);
+
+  ob[0] = 0;
+
+  for (uint32 i=1; i<=p.numReads; i++) {
+    uint32  len = 0;
+    uint32  lib = 0;
+
+    makeRead(i, p, fr[i].fragLength, fr[i].mateIID, lib, len);
+
+    fr[i].libIID   = lib;
+    fr[i].isRandom = 1;
+
+    ob[i] = numOlaps;
+
+    if (len == 0)
+      continue;
+
+    bc[i].container   = i - 1;
+    bc[i].isContained = 1;
+
+    for (uint32 j=0; j<len; j++)
+      makeOlap(i, p);
+
+    numOlaps += len;
+  }
+
+  ob[p.numReads + 1] = numOlaps;
+
+  uint32  *ol = new uint32 [numOlaps];
+
+  srand48(p.seed);
+
+  for (uint32 i=1; i<=p.numReads; i++) {
+    uint32  a, b, c, len = 0;
+
+    makeRead(i, p, a, b, c, len);
+
+    for (uint32 j=0; j<len; j++)
+      ol[ob[i]++] = makeOlap(i, p);
+  }
+
+  for (uint32 i=p.numReads + 1; i>0; i--)
+    ob[i] = ob[i-1];
+  ob[0] = 0;
+
+  for (uint32 i=1; i<=p.numReads; i++)
+    if (ob[i+1] - ob[i] >= 16)
+      std::sort(ol + ob[i], ol + ob[i+1]);
+
+  double   t1   = getTime();
+  double   rss1 = getResidentMB();
+
+  uint64   hits = 0;
+
+  for (uint32 q=0; q<p.numQueries; q++) {
+    uint32  i, o;
+
+    makeQuery(p, i, o);
+
+    uint32 *bgn = ol + ob[i];
+    uint32 *end = ol + ob[i+1];
+
+    if (end - bgn < 16) {
+      for (; bgn < end; bgn++)
+        if (*bgn == o) {
+          hits++;
+          break;
+        }
+    } else {
+      if (std::binary_search(bgn, end, o))
+        hits++;
+    }
+  }
+
+  double   t2   = getTime();
+
+  uint64   sum = 0;
+
+  for (uint32 q=0; q<p.numQueries; q++) {
+    uint32  i, o;
+
+    makeQuery(p, i, o);
+
+    sum += fr[i].libIID + fr[fr[i].mateIID].fragLength + fr[o].fragLength;
+  }
+
+  double   t3   = getTime();
+
+  delete [] fr;
+  delete [] bc;
+  delete [] ob;
+  delete [] ol;
+
+  double   t4   = getTime();
+
+  fprintf(stdout, "new:  build %8.3fs  contains %8.3fs  frags %8.3fs  free %8.3fs  RSS %10.1f MB  (" F_U64" olaps, " F_U64" hits, sum " F_U64")\n",
+          t1 - t0, t2 - t1, t3 - t2, t4 - t3, rss1 - rss0, numOlaps, hits, sum);
+}
+
+
+
+int
+main(int argc, char **argv) {
+  benchParams  p;
+
+  p.numReads          = 100000000;
+  p.containedFraction = 0.3;
+  p.olapsPerContained = 8;
+  p.numQueries        = 0;
+  p.seed              = 1;
+
+  argc = AS_configure(argc, argv);
+
+  int arg = 1;
+  int err = 0;
+  while (arg < argc) {
+    if        (strcmp(argv[arg], "-n") == 0) {
+      p.numReads = strtoul(argv[++arg], NULL, 10);
+
+    } else if (strcmp(argv[arg], "-c") == 0) {
+      p.containedFraction = atof(argv[++arg]);
+
+    } else if (strcmp(argv[arg], "-o") == 0) {
+      p.olapsPerContained = atoi(argv[++arg]);
+
+    } else if (strcmp(argv[arg], "-q") == 0) {
+      p.numQueries = strtoul(argv[++arg], NULL, 10);
+
+    } else if (strcmp(argv[arg], "-s") == 0) {
+      p.seed = atoi(argv[++arg]);
+
+    } else {
+      fprintf(stderr, "Invalid option: '%s'\n", argv[arg]);
+      err++;
+    }
+    arg++;
+  }
+  if ((err) || (p.numReads < 2) || (p.olapsPerContained == 0)) {
+    fprintf(stderr, "usage: %s [-n reads] [-c fraction] [-o olaps] [-q queries] [-s seed]\n", argv[0]);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  -n reads      Build a synthetic graph of this many reads (default 100 million)\n");
+    fprintf(stderr, "  -c fraction   Fraction of reads that are contained (default 0.3)\n");
+    fprintf(stderr, "  -o olaps      Average near-containment overlaps per contained read (default 8)\n");
+    fprintf(stderr, "  -q queries    Number of random lookups (default one per read)\n");
+    fprintf(stderr, "  -s seed       Random seed\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  The new layout is timed first, then the old.  RSS is the growth in resident\n");
+    fprintf(stderr, "  memory while the tables are built.\n");
+    exit(1);
+  }
+
+  if (p.numQueries == 0)
+    p.numQueries = p.numReads;
+
+  fprintf(stdout, "%u reads, %.2f contained, %u near-containment overlaps per contained read, %u queries\n",
+          p.numReads, p.containedFraction, p.olapsPerContained, p.numQueries);
+
+  benchNew(p);
+  benchOld(p);
+
+  return(0);
+}
@@ -152,7 +152,9 @@ main (int argc, char * argv []) {
   bool      popBubbles              = false;
   bool      breakIntersections      = false;
   bool      joinUnitigs             = false;
+  bool      useRepeatFlags          = false;
   int       badMateBreakThreshold   = -7;
+  uint32    numThreads              = 1;
 
   argc = AS_configure(argc, argv);
 
@@ -188,6 +190,9 @@ main (int argc, char * argv []) {
     } else if (strcmp(argv[arg], "-J") == 0) {
       joinUnitigs = true;
 
+    } else if (strcmp(argv[arg], "-R") == 0) {
+      useRepeatFlags = true;
+
     } else if (strcmp(argv[arg], "-e") == 0) {
       erate = atof(argv[++arg]);
 
@@ -200,6 +205,9 @@ main (int argc, char * argv []) {
     } else if (strcmp(argv[arg], "-s") == 0) {
       genome_size = atol(argv[++arg]);
 
+    } else if (strcmp(argv[arg], "-t") == 0) {
+      numThreads = atoi(argv[++arg]);
+
     } else {
       err++;
     }
@@ -239,6 +247,12 @@ main (int argc, char * argv []) {
     fprintf(stderr, "\n");
     fprintf(stderr, "  -b         Break promisciuous unitigs at unitig intersection points\n");
     fprintf(stderr, "  -m 7       Break a unitig if a region has more than 7 bad mates\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  -R         Ignore overlaps of reads flagged as repeats in the gkpStore\n");
+    fprintf(stderr, "             (see markRepeatReads)\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  -t n       Use n threads for unitig construction, bubble popping, mate checking\n");
+    fprintf(stderr, "             and output; results are identical for any n\n");
     fprintf(stderr, " \n");
     fprintf(stderr, "Overlap Selection - an overlap will be considered for use in a unitig if either of\n");
     fprintf(stderr, "                    the following conditions hold:\n");
@@ -275,6 +289,7 @@ main (int argc, char * argv []) {
   fprintf(stderr, "Bubble popping        = %s\n", (popBubbles) ? "on" : "off");
   fprintf(stderr, "Intersection breaking = %s\n", (breakIntersections) ? "on" : "off");
   fprintf(stderr, "Bad mate threshold    = %d\n", badMateBreakThreshold);
+  fprintf(stderr, "Repeat read flags     = %s\n", (useRepeatFlags) ? "on" : "off");
   fprintf(stderr, "Error threshold       = %.3f (%.3f%%)\n", erate, erate * 100);
   fprintf(stderr, "Error limit           = %.3f errors\n", elimit);
   fprintf(stderr, "Genome Size           = " F_S64"\n", genome_size);
@@ -290,15 +305,15 @@ main (int argc, char * argv []) {
 
   debugfi = fragInfo;
 
-  BestOverlapGraph      *BOG = new BestOverlapGraph(fragInfo, ovlStoreUniq, ovlStoreRept, erate, elimit);
+  BestOverlapGraph      *BOG = new BestOverlapGraph(fragInfo, ovlStoreUniq, ovlStoreRept, erate, elimit, useRepeatFlags);
 
   bog = BOG;
 
   ChunkGraph *cg = new ChunkGraph(fragInfo, BOG);
-  UnitigGraph utg(fragInfo, BOG);
+  UnitigGraph utg(fragInfo, BOG, numThreads);
   utg.build(cg, ovlStoreUniq, ovlStoreRept, breakIntersections, joinUnitigs, popBubbles, output_prefix);
 
-  MateChecker  mateChecker(fragInfo);
+  MateChecker  mateChecker(fragInfo, numThreads);
   mateChecker.checkUnitigGraph(utg, badMateBreakThreshold);
 
   float globalARate = utg.getGlobalArrivalRate(gkpStore->gkStore_getNumRandomFragments(), genome_size);
@@ -38,6 +38,7 @@
 
 #include "AS_global.h"
 #include "AS_PER_gkpStore.h"
+#include "AS_UTL_coverageStat.h"
 #include "AS_UTL_Var.h"
 #include "AS_UTL_param_proc.h"
 
@@ -285,7 +286,8 @@ void view_fgb_chkpnt(char *Store_Path_Prefix,
 
 //  AS_CGB_fgb.c
 void reorder_edges(Tfragment *frags,
-                   Tedge *edges);
+                   Tedge *edges,
+                   int numThreads);
 
 //  AS_CGB_count_fragment_and_edge_labels.c
 void count_fragment_and_edge_labels(Tfragment  frags[],
@@ -295,11 +297,8 @@ void count_fragment_and_edge_labels(Tfragment  frags[],
 
 ////////////////////////////////////////
 //  AS_CGB_cgb.c
-int count_the_randomly_sampled_fragments_in_a_chunk(Tfragment   frags[],
-                                                    TChunkFrag  chunkfrags[],
-                                                    TChunkMesg  thechunks[],
-                                                    IntChunk_ID chunk_index,
-                                                    gkStore *gkp);
+int count_the_randomly_sampled_fragments_in_a_chunk(TChunkMesg  thechunks[],
+                                                    IntChunk_ID chunk_index);
 
 
 //  recalibrate: boolean flag to recalibrate global arrival rate to
@@ -313,8 +312,7 @@ float compute_the_global_fragment_arrival_rate(int           recalibrate,
                                                Tedge        *edges,
                                                float         estimated_global_fragment_arrival_rate,
                                                TChunkFrag   *chunkfrags,
-                                               TChunkMesg   *thechunks,
-                                               gkStore *gkp);
+                                               TChunkMesg   *thechunks);
 
 //  AS_CGB_cgb.c (end)
 ////////////////////////////////////////
@@ -392,97 +390,11 @@ int is_there_an_overlap_path(const Tfragment * const frags,
 
 
 
-// Rho is the number of bases in the chunk between the first fragment
-// arrival and the last fragment arrival.  It is the sum of the
-// fragment overhangs in the chunk. For intuitive purposes you can
-// think of it as the length of the chunk minus the length of the last
-// fragment. Thus a singleton chunk has a rho equal to zero.
-//
-// A singleton chunk provides no information as to its local fragment
-// arrival rate. We need at least two closely spaced fragments that
-// are randomly sampled from the chunk to get a local estimate of the
-// fragment arrival rate.
-//
-// The local arrival rate of fragments in the chunk is:
-//
-// arrival_rate_local = ((float)(nfrag_randomly_sampled_in_chunk-1))/(float)rho
-//
-// The arrival distance of fragments in the chunk is the reciprocal of
-// the last formula:
-//
-// arrival_distance_local = ((float)rho)/((float)(nfrag_randomly_sampled_in_chunk-1))
-//
-// Note a problem with this formula is that a singleton chunk has a
-// coverage discriminator statistic of 0/0.
-//
-// The formula for the coverage discriminator statistic for the chunk
-// is:
-//
-// (arrival_rate_global/arrival_rate_local - ln(2))*(nfrag_randomly_sampled_in_chunk-1)
-//
-// The division by zero singularity cancels out to give the formula:
-//
-// (arrival_rate_global*rho - ln(2)*(nfrag_randomly_sampled_in_chunk-1)
-//
-// Call fragments that are not randomly sampled in the genome as
-// "guide" fragments.  The modification for guides recognizes that
-// guides are not randomly spaced fragments in the genome.  Therefore
-// they should not contribute to the fragment count in the local
-// arrival rate discriminator statistic.
-//
-// Be careful of falsely creating a negative number while using
-// unsigned integer arthimetic.  The behavior is not what we want
-// here.
-//
-// The coverage discriminator statistic should be positive for single
-// coverage, negative for multiple coverage, and near zero for
-// indecisive.
-//
-// ADJUST_FOR_PARTIAL_EXCESS: The standard statistic gives log
-// likelihood ratio of expected depth vs.  twice expected depth; but
-// when enough fragments are present, we can actually test whether
-// depth exceeds expected even fractionally; in deeply sequenced
-// datasets (e.g. bacterial genomes), this has been observed for
-// repetitive segments.
-//
-static float compute_coverage_statistic(int64  rho,
-                                        int    number_of_randomly_sampled_fragments_in_chunk,
-                                        float  global_fragment_arrival_rate) {
-
- float ln2 = 0.693147f; // Logarithm base 2 of "e".
- float sqrt2 = 1.414213f;
-
- float coverage_statistic = 0.f;
- if (global_fragment_arrival_rate > 0.f)
-   coverage_statistic = rho*global_fragment_arrival_rate - ln2*(number_of_randomly_sampled_fragments_in_chunk - 1);
-
-#undef ADJUST_FOR_PARTIAL_EXCESS
-#ifdef ADJUST_FOR_PARTIAL_EXCESS
-  if(rho>0&&global_fragment_arrival_rate>0.f){
-    float lambda = global_fragment_arrival_rate * rho;
-    float zscore = ((number_of_randomly_sampled_fragments_in_chunk -1)-lambda) / sqrt(lambda);
-    float p = .5 - erf(zscore/sqrt2)*.5;
-    if(coverage_statistic>5 && p < .001){
-      fprintf(stderr,"Standard unitigger a-stat is %f, but only %e chance of this great an excess of fragments: obs = %d, expect = %g rho = " F_S64 " Will reset a-stat to 1.5\n",
-	      coverage_statistic,p,
-	      number_of_randomly_sampled_fragments_in_chunk-1,
-	      lambda,rho);
-      return 1.5;
-    }
-  }
-#endif
-
-  return coverage_statistic;
-}
-
-
-
-
-
-
-
-
 extern int (*compare_edge_function)(const void *a, const void *b);
 
+//  AS_CGB_fgb.c
+int compare_edge_weak(const void * const aa, const void * const bb);
+int compare_edge_strong(const void * const aa, const void * const bb);
+
 
 #endif /*AS_CGB_ALL_INCLUDE*/
@@ -236,6 +236,8 @@ static void set_con_fragment(Tfragment frags[],IntFragment_ID i,int value)
 { VAgetaccess(Afragment,frags,i,contained) = value;}
 static void set_spur_fragment(Tfragment frags[],IntFragment_ID i,int value)
 { VAgetaccess(Afragment,frags,i,spur) = value;}
+static void set_nonrandom_fragment(Tfragment frags[],IntFragment_ID i,int value)
+{ VAgetaccess(Afragment,frags,i,nonrandom) = value;}
 
 
 
@@ -271,6 +273,13 @@ static int get_con_fragment(const Tfragment * const frags,IntFragment_ID i)
 { return (int) VAgetaccess(Afragment,frags,i,contained);}
 static int get_spur_fragment(const Tfragment * const frags,IntFragment_ID i)
 { return (int) VAgetaccess(Afragment,frags,i,spur);}
+static int get_nonrandom_fragment(const Tfragment * const frags,IntFragment_ID i)
+{ return (int) VAgetaccess(Afragment,frags,i,nonrandom);}
+
+// Only AS_READ and AS_EXTR fragments that are not flagged nonrandom are
+// used in Gene Myers coverage discriminator A-statistic.
+static int get_random_fragment(const Tfragment * const frags,IntFragment_ID i)
+{ return (AS_FA_RANDOM(get_typ_fragment(frags,i)) && !get_nonrandom_fragment(frags,i));}
 
 
 static void set_segstart_vertex
@@ -113,6 +113,9 @@ typedef struct {
   // A flag indicating if this fragment is contained in the fragment
   // graph.
   unsigned int spur : 1;
+  unsigned int nonrandom : 1;
+  // A flag indicating if this fragment is not randomly sampled from
+  // the genome; it is not counted in the coverage statistic.
 
   unsigned int prefix_blessed : 1;
   unsigned int suffix_blessed : 1;
@@ -135,6 +138,9 @@ typedef struct {
   int32     chunk_asx;
   int32     chunk_bsx;
   IntFragment_ID    num_frags;
+  IntFragment_ID    num_random_frags;
+  // The number of randomly sampled fragments in the chunk, counted
+  // when the chunk is built; see AS_UTL_coverageStatistic().
   IntFragment_ID    f_list; /* The index into a TChunkFrag array. */
 
   // The following is not necessary. The info available from
@@ -206,6 +212,12 @@ typedef struct {
 
   char * ovl_files_list_fname;
 
+  char * graph_snapshot_output;
+  // Save the fragment graph, as read from the stores, to this file.
+
+  char * graph_snapshot_input;
+  // Read the fragment graph from this file instead of the stores.
+
   int            recalibrate_global_arrival_rate;
   int            dechord_the_graph;
   int            create_dump_file;
@@ -233,6 +245,9 @@ typedef struct {
   int            use_consensus;
   int            dont_count_chimeras;
   int            fragment_count_target;
+
+  int            num_threads;
+  // Threads for reading the overlap store and sorting the edges.
 } UnitiggerGlobals;
 
 int main_fgb (THeapGlobals  * heapva,
@@ -64,6 +64,8 @@ public:
   int    removeNonOverlapingContigsFromScaffold;
   int    doUnjiggleWhenMerging;
 
+  int    numThreads;
+
   char   outputPrefix[FILENAME_MAX];
 
   char   gkpStoreName[FILENAME_MAX];
@@ -371,9 +371,33 @@ typedef struct {
   int32  max_offset;
 } ChunkOverlapCheckT;
 
+VA_DEF(ChunkOverlapCheckT);
+
+//  The result of aligning the consensus sequences for one
+//  ChunkOverlapCheckT, computed ahead of time by
+//  ComputeChunkOverlapBatch().  The spec, range and error rate are the
+//  inputs; found, begpos, endpos and length are what DP_Compare()
+//  returned.
+//
+typedef struct {
+  ChunkOverlapSpecT spec;
+
+  int32  minOverlap;
+  int32  maxOverlap;
+  float  errorRate;
+
+  int32  found;
+  int32  begpos;
+  int32  endpos;
+  int32  length;
+} ChunkOverlapAlignT;
+
 typedef struct {
   HashTable_AS *hashTable;
   Heap_AS      *ChunkOverlaps;  //  Heap of ChunkOverlapCheckT
+
+  ChunkOverlapAlignT *batch;    //  Sorted by spec, see ComputeChunkOverlapBatch()
+  int32               batchLen;
 } ChunkOverlapperT;
 //
 //
@@ -1442,6 +1466,34 @@ Overlap* OverlapContigs(NodeCGW_T *contig1, NodeCGW_T *contig2,
 void ComputeOverlaps(GraphCGW_T *graph, int addEdgeMates,
                      int recomputeCGBOverlaps);
 
+//  Align the consensus sequences for each of the (canonical) overlaps in
+//  olaps[], using GlobalData->numThreads threads.  Only the spec, min/max
+//  overlap and error rate are used.  Later calls to OverlapChunks() and
+//  ComputeOverlaps() for the same spec, range and error rate use the
+//  result instead of aligning again.
+//
+//  The results are valid only as long as the consensus sequences of the
+//  chunks involved do not change; ClearChunkOverlapBatch() discards
+//  them, and should be called before modifying the graph.
+//
+void ComputeChunkOverlapBatch(GraphCGW_T *graph,
+                              ChunkOverlapCheckT *olaps,
+                              int32 olapsLen);
+
+void ClearChunkOverlapBatch(ChunkOverlapperT *chunkOverlapper);
+
+//  Appends to olaps the canonical overlap that OverlapChunks() would
+//  align for these arguments, for use with ComputeChunkOverlapBatch().
+//  Nothing is appended if OverlapChunks() would reuse an overlap already
+//  in the store.
+//
+void AppendChunkOverlapRequest(VA_TYPE(ChunkOverlapCheckT) *olaps,
+                               CDS_CID_t cidA, CDS_CID_t cidB,
+                               PairOrient orientation,
+                               int32 minOverlap,
+                               int32 maxOverlap,
+                               float errorRate);
+
 //
 //
 //
@@ -103,6 +103,19 @@ PopulateScaffoldAlignmentInterface(CIScaffoldT * scaffoldA,
                                    ScaffoldAlignmentInterface * sai);
 
 
+//  Appends the chunk overlaps PopulateScaffoldAlignmentInterface() may
+//  compute for this edge to requests, without computing any of them, so
+//  they can be aligned together by ComputeChunkOverlapBatch().  Overlaps
+//  it looks for only when an earlier one is not found are included.
+//  sai is used as scratch space.
+int
+CollectScaffoldAlignmentOverlaps(CIScaffoldT * scaffoldA,
+                                 CIScaffoldT * scaffoldB,
+                                 SEdgeT * sEdge,
+                                 ScaffoldAlignmentInterface * sai,
+                                 VA_TYPE(ChunkOverlapCheckT) * requests);
+
+
 SEdgeT *
 MakeScaffoldAlignmentAdjustments(CIScaffoldT * scaffoldA,
                                  CIScaffoldT * scaffoldB,
@@ -29,6 +29,7 @@
 
 #include "AS_global.h"
 #include "AS_PER_gkpStore.h"
+#include "MultiAlign.h"
 
 #define CONTIG_BASES          1000
 
@@ -53,6 +54,33 @@ typedef struct {
 
 extern debugflags_t            debug;
 
+
+//  Scratch space for examineGap().  Each thread examining gaps needs
+//  its own.
+//
+class examineGapBuffers {
+public:
+  examineGapBuffers() {
+    lContigConsensus = CreateVA_char(4096);
+    rContigConsensus = CreateVA_char(4096);
+    lContigQuality   = CreateVA_char(4096);
+    rContigQuality   = CreateVA_char(4096);
+  };
+  ~examineGapBuffers() {
+    DeleteVA_char(lContigConsensus);
+    DeleteVA_char(rContigConsensus);
+    DeleteVA_char(lContigQuality);
+    DeleteVA_char(rContigQuality);
+  };
+
+  gkFragment      fr;
+
+  VA_TYPE(char)  *lContigConsensus;
+  VA_TYPE(char)  *rContigConsensus;
+  VA_TYPE(char)  *lContigQuality;
+  VA_TYPE(char)  *rContigQuality;
+};
+
 extern int                     totalContigsBaseChange;
 extern gkFragment              fsread;
 extern int                     iterNumber;
@@ -0,0 +1,254 @@
+/**************************************************************************
+ * This file is part of Celera Assembler, a software program that
+ * assembles whole-genome shotgun reads into contigs and scaffolds.
+ * Copyright (C) 2010, J. Craig Venter Institute.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received (LICENSE.txt) a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *************************************************************************/
+
+// static const char *rcsid = "$Id$";
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "AS_LIN_bandedCholesky.h"
+
+#define A_MIN(a, b)  (((a) < (b)) ? (a) : (b))
+#define A_MAX(a, b)  (((a) > (b)) ? (a) : (b))
+
+//  Number of factored columns applied to the trailing band at once.
+//  update4() is written for exactly this many.
+#define PANEL_WIDTH  4
+
+
+#ifndef AS_LIN_BLOCKED_CHOLESKY
+
+extern int dpbtrf_(const char *, long *, long *, double *, long *, long *);
+extern int dpbtrs_(const char *, long *, long *, long *, double *, long *, double *, long *, long *);
+
+int
+AS_LIN_bandedCholeskyFactor(int n, int kd, double *ab, int ldab) {
+  long  N = n, KD = kd, LDAB = ldab, info = 0;
+
+  dpbtrf_("L", &N, &KD, ab, &LDAB, &info);
+
+  return((int)info);
+}
+
+void
+AS_LIN_bandedCholeskySolve(int n, int kd, const double *ab, int ldab, double *b, int first) {
+  long  N = n, KD = kd, LDAB = ldab, NRHS = 1, info = 0;
+
+  dpbtrs_("L", &N, &KD, &NRHS, (double *)ab, &LDAB, b, &N, &info);
+}
+
+#else
+
+
+//  y[0..len-1] -= s * x[0..len-1]
+static
+void
+axpyNeg(double *y, const double *x, double s, int len) {
+  int  i = 0;
+
+#ifdef __SSE2__
+  __m128d  ss = _mm_set1_pd(s);
+
+  for (; i+2 <= len; i += 2)
+    _mm_storeu_pd(y+i, _mm_sub_pd(_mm_loadu_pd(y+i), _mm_mul_pd(ss, _mm_loadu_pd(x+i))));
+#endif
+
+  for (; i < len; i++)
+    y[i] -= s * x[i];
+}
+
+
+static
+double
+dot(const double *x, const double *y, int len) {
+  double  sum = 0.0;
+  int     i   = 0;
+
+#ifdef __SSE2__
+  __m128d  s0 = _mm_setzero_pd();
+  __m128d  s1 = _mm_setzero_pd();
+  double   ss[2];
+
+  for (; i+4 <= len; i += 4) {
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x+i),   _mm_loadu_pd(y+i)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(x+i+2), _mm_loadu_pd(y+i+2)));
+  }
+
+  _mm_storeu_pd(ss, _mm_add_pd(s0, s1));
+
+  sum = ss[0] + ss[1];
+#endif
+
+  for (; i < len; i++)
+    sum += x[i] * y[i];
+
+  return(sum);
+}
+
+
+//  y[k] -= s0*x0[k] + s1*x1[k] + s2*x2[k] + s3*x3[k]
+//
+//  This is the whole point of the blocking: the target column is read
+//  and written once for four updates.
+static
+void
+update4(double *y,
+        const double *x0, const double *x1, const double *x2, const double *x3,
+        double s0, double s1, double s2, double s3,
+        int len) {
+  int  i = 0;
+
+#ifdef __SSE2__
+  __m128d  v0 = _mm_set1_pd(s0);
+  __m128d  v1 = _mm_set1_pd(s1);
+  __m128d  v2 = _mm_set1_pd(s2);
+  __m128d  v3 = _mm_set1_pd(s3);
+
+  for (; i+2 <= len; i += 2) {
+    __m128d  a = _mm_add_pd(_mm_mul_pd(v0, _mm_loadu_pd(x0+i)), _mm_mul_pd(v1, _mm_loadu_pd(x1+i)));
+    __m128d  b = _mm_add_pd(_mm_mul_pd(v2, _mm_loadu_pd(x2+i)), _mm_mul_pd(v3, _mm_loadu_pd(x3+i)));
+
+    _mm_storeu_pd(y+i, _mm_sub_pd(_mm_loadu_pd(y+i), _mm_add_pd(a, b)));
+  }
+#endif
+
+  for (; i < len; i++)
+    y[i] -= (s0 * x0[i] + s1 * x1[i]) + (s2 * x2[i] + s3 * x3[i]);
+}
+
+
+//  Right-looking band Cholesky.  Columns are factored in panels of
+//  PANEL_WIDTH; within a panel the update is applied one column at a
+//  time, then the whole panel is applied to each trailing column that
+//  its band reaches.
+//
+int
+AS_LIN_bandedCholeskyFactor(int n, int kd, double *ab, int ldab) {
+  int  j0, j1, j, c, d, i, p;
+
+  for (j0 = 0; j0 < n; j0 += PANEL_WIDTH) {
+    j1 = A_MIN(j0 + PANEL_WIDTH, n);
+
+    //  Factor the panel.
+
+    for (j = j0; j < j1; j++) {
+      double *cj  = ab + (long)j * ldab;      //  cj[d] = A(j+d, j)
+      int     len = A_MIN(kd, n-1-j);
+      double  ajj;
+
+      if (cj[0] <= 0.0)
+        return(j+1);
+
+      ajj   = sqrt(cj[0]);
+      cj[0] = ajj;
+
+      for (d=1; d<=len; d++)
+        cj[d] /= ajj;
+
+      //  A(i,c) -= A(i,j) * A(c,j), for panel columns c and i = c..j+len
+
+      for (c = j+1; (c < j1) && (c <= j+len); c++)
+        axpyNeg(ab + (long)c * ldab, cj + (c-j), cj[c-j], j + len - c + 1);
+    }
+
+    //  Apply the panel to the trailing columns.
+
+    for (c = j1; c <= A_MIN(n-1, j1-1+kd); c++) {
+      double *tc    = ab + (long)c * ldab;    //  tc[i-c] = A(i,c)
+      int     ps    = A_MAX(j0, c-kd);        //  first panel column reaching row c
+      int     iFull = A_MIN(n-1, ps+kd);      //  rows every contributing column reaches
+      int     iEnd  = A_MIN(n-1, j1-1+kd);    //  rows any panel column reaches
+      int     len   = iFull - c + 1;
+
+      //  Rows c..iFull get all of the panel columns ps..j1-1.
+
+      if (j1 - ps == PANEL_WIDTH) {
+        const double *l0 = ab + (long)(ps+0) * ldab;
+        const double *l1 = ab + (long)(ps+1) * ldab;
+        const double *l2 = ab + (long)(ps+2) * ldab;
+        const double *l3 = ab + (long)(ps+3) * ldab;
+
+        update4(tc,
+                l0 + (c-ps-0), l1 + (c-ps-1), l2 + (c-ps-2), l3 + (c-ps-3),
+                l0[c-ps-0],    l1[c-ps-1],    l2[c-ps-2],    l3[c-ps-3],
+                len);
+      } else {
+        for (p = ps; p < j1; p++) {
+          const double *lp = ab + (long)p * ldab;
+          axpyNeg(tc, lp + (c-p), lp[c-p], len);
+        }
+      }
+
+      //  The remaining rows are only reached by the later panel
+      //  columns; this is at most a PANEL_WIDTH triangle.
+
+      for (i = iFull+1; i <= iEnd; i++)
+        for (p = i-kd; p < j1; p++) {
+          const double *lp = ab + (long)p * ldab;
+          tc[i-c] -= lp[c-p] * lp[i-p];
+        }
+    }
+  }
+
+  return(0);
+}
+
+
+void
+AS_LIN_bandedCholeskySolve(int n, int kd, const double *ab, int ldab, double *b, int first) {
+  int  last = -1;
+  int  j;
+
+  //  Both passes are a chain of dependent updates; the reciprocal of
+  //  the diagonal does not depend on b, so multiplying by it keeps the
+  //  divide off the chain.
+  //
+  //  cgw solves against vectors that are mostly zero.  Zero entries
+  //  are skipped in the forward pass (as dtbsv does), and everything
+  //  after the last non-zero entry is still zero after it, so the
+  //  backward pass starts there.
+
+  //  Solve L y = b.
+
+  for (j = first; j < n; j++) {
+    const double *cj = ab + (long)j * ldab;
+
+    if (b[j] == 0.0)
+      continue;
+
+    b[j] *= 1.0 / cj[0];
+    last  = j;
+
+    axpyNeg(b + j + 1, cj + 1, b[j], A_MIN(kd, n-1-j));
+  }
+
+  //  Solve L' x = y.
+
+  for (j = last; j >= 0; j--) {
+    const double *cj = ab + (long)j * ldab;
+
+    b[j] = (b[j] - dot(cj + 1, b + j + 1, A_MIN(kd, n-1-j))) * (1.0 / cj[0]);
+  }
+}
+
+#endif  //  AS_LIN_BLOCKED_CHOLESKY
@@ -0,0 +1,61 @@
+/**************************************************************************
+ * This file is part of Celera Assembler, a software program that
+ * assembles whole-genome shotgun reads into contigs and scaffolds.
+ * Copyright (C) 2010, J. Craig Venter Institute.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received (LICENSE.txt) a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *************************************************************************/
+
+#ifndef AS_LIN_BANDEDCHOLESKY_H
+#define AS_LIN_BANDEDCHOLESKY_H
+
+//  Cholesky factorization and solve of a symmetric positive definite
+//  band matrix, for the one case cgw uses: uplo = "L", one right hand
+//  side.  By default both calls go to the f2c dpbtrf_() and dpbtrs_().
+//
+//  The matrix is in LAPACK lower band storage: column j of the matrix
+//  is at ab[j*ldab], with ab[j*ldab + d] = A(j+d, j) for d = 0..kd.
+//  ldab must be at least kd+1.
+//
+//  Compile with -DAS_LIN_BLOCKED_CHOLESKY to use a blocked
+//  factorization instead (four columns are applied to the trailing
+//  band in one pass, and the inner loops use SSE2 when the compiler
+//  provides it).  Results agree with dpbtrf_()/dpbtrs_() to rounding;
+//  they are not bit-identical, so cgw gap estimates change.  It is
+//  only faster for very narrow bands; see 'make test'.
+//
+//  Both are reentrant.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  Returns 0 on success, or j+1 if the leading minor of order j+1 is
+//  not positive definite (same as dpbtrf's info).
+int
+AS_LIN_bandedCholeskyFactor(int n, int kd, double *ab, int ldab);
+
+//  Solves A x = b using the factor from AS_LIN_bandedCholeskyFactor(),
+//  overwriting b with x.  b[0..first-1] must be zero; they are skipped
+//  during forward substitution.  Pass first = 0 if nothing is known
+//  about b.
+void
+AS_LIN_bandedCholeskySolve(int n, int kd, const double *ab, int ldab, double *b, int first);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  //  AS_LIN_BANDEDCHOLESKY_H
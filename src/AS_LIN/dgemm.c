@@ -18,12 +18,12 @@
 	    i__3;
 
     /* Local variables */
-    static integer info;
-    static logical nota, notb;
-    static doublereal temp;
-    static integer i, j, l, ncola;
+    integer info;
+    logical nota, notb;
+    doublereal temp;
+    integer i, j, l, ncola;
     extern logical lsame_(const char *, const char *);
-    static integer nrowa, nrowb;
+    integer nrowa, nrowb;
     extern /* Subroutine */ int xerbla_(char *, integer *);
 
 
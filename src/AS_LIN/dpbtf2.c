@@ -110,15 +110,15 @@
     /* Local variables */
     extern /* Subroutine */ int dsyr_(char *, integer *, doublereal *,
 	    doublereal *, integer *, doublereal *, integer *);
-    static integer j;
+    integer j;
     extern /* Subroutine */ int dscal_(integer *, doublereal *, doublereal *,
 	    integer *);
     extern logical lsame_(const char *, const char *);
-    static logical upper;
-    static integer kn;
+    logical upper;
+    integer kn;
     extern /* Subroutine */ int xerbla_(char *, integer *);
-    static doublereal ajj;
-    static integer kld;
+    doublereal ajj;
+    integer kld;
 
 
 
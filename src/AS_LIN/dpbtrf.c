@@ -105,8 +105,8 @@
     /* System generated locals */
     integer ab_dim1, ab_offset, i__1, i__2, i__3, i__4;
     /* Local variables */
-    static doublereal work[1056]	/* was [33][32] */;
-    static integer i, j;
+    doublereal work[1056]	/* was [33][32] */;
+    integer i, j;
     extern /* Subroutine */ int dgemm_(char *, char *, integer *, integer *,
 	    integer *, doublereal *, doublereal *, integer *, doublereal *,
 	    integer *, doublereal *, doublereal *, integer *);
@@ -114,13 +114,13 @@
     extern /* Subroutine */ int dtrsm_(char *, char *, char *, char *,
 	    integer *, integer *, doublereal *, doublereal *, integer *,
 	    doublereal *, integer *);
-    static integer i2, i3;
+    integer i2, i3;
     extern /* Subroutine */ int dsyrk_(char *, char *, integer *, integer *,
 	    doublereal *, doublereal *, integer *, doublereal *, doublereal *,
 	     integer *), dpbtf2_(const char *, integer *, integer *,
 	     doublereal *, integer *, integer *), dpotf2_(const char *,
 	    integer *, doublereal *, integer *, integer *);
-    static integer ib, nb, ii, jj;
+    integer ib, nb, ii, jj;
     extern /* Subroutine */ int xerbla_(char *, integer *);
     extern integer ilaenv_(integer *, const char *, const char *, integer *, integer *,
 	    integer *, integer *, ftnlen, ftnlen);
@@ -76,11 +76,11 @@
     /* System generated locals */
     integer ab_dim1, ab_offset, b_dim1, b_offset, i__1;
     /* Local variables */
-    static integer j;
+    integer j;
     extern logical lsame_(const char *, const char *);
     extern /* Subroutine */ int dtbsv_(char *, char *, char *, integer *,
 	    integer *, doublereal *, integer *, doublereal *, integer *);
-    static logical upper;
+    logical upper;
     extern /* Subroutine */ int xerbla_(char *, integer *);
 
 
@@ -80,16 +80,16 @@
     /* Local variables */
     extern doublereal ddot_(integer *, doublereal *, integer *, doublereal *,
 	    integer *);
-    static integer j;
+    integer j;
     extern /* Subroutine */ int dscal_(integer *, doublereal *, doublereal *,
 	    integer *);
     extern logical lsame_(const char *, const char *);
     extern /* Subroutine */ int dgemv_(char *, integer *, integer *,
 	    doublereal *, doublereal *, integer *, doublereal *, integer *,
 	    doublereal *, doublereal *, integer *);
-    static logical upper;
+    logical upper;
     extern /* Subroutine */ int xerbla_(char *, integer *);
-    static doublereal ajj;
+    doublereal ajj;
 
 
 
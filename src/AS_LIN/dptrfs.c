@@ -101,24 +101,24 @@
     integer b_dim1, b_offset, x_dim1, x_offset, i__1, i__2;
     doublereal d__1, d__2, d__3;
     /* Local variables */
-    static doublereal safe1, safe2;
-    static integer i, j;
-    static doublereal s;
+    doublereal safe1, safe2;
+    integer i, j;
+    doublereal s;
     extern /* Subroutine */ int daxpy_(integer *, doublereal *, doublereal *,
 	    integer *, doublereal *, integer *);
-    static integer count;
-    static doublereal bi;
+    integer count;
+    doublereal bi;
     extern doublereal dlamch_(char *);
-    static doublereal cx, dx, ex;
-    static integer ix;
+    doublereal cx, dx, ex;
+    integer ix;
     extern integer idamax_(integer *, doublereal *, integer *);
-    static integer nz;
-    static doublereal safmin;
+    integer nz;
+    doublereal safmin;
     extern /* Subroutine */ int xerbla_(char *, integer *);
-    static doublereal lstres;
+    doublereal lstres;
     extern /* Subroutine */ int dpttrs_(integer *, integer *, doublereal *,
 	    doublereal *, doublereal *, integer *, integer *);
-    static doublereal eps;
+    doublereal eps;
 
 
 
@@ -59,7 +59,7 @@
     /* System generated locals */
     integer b_dim1, b_offset, i__1, i__2;
     /* Local variables */
-    static integer i, j;
+    integer i, j;
     extern /* Subroutine */ int xerbla_(char *, integer *);
 
 
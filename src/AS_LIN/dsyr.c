@@ -15,11 +15,11 @@
     integer a_dim1, a_offset, i__1, i__2;
 
     /* Local variables */
-    static integer info;
-    static doublereal temp;
-    static integer i, j;
+    integer info;
+    doublereal temp;
+    integer i, j;
     extern logical lsame_(const char *, const char *);
-    static integer ix, jx, kx;
+    integer ix, jx, kx = 0;
     extern /* Subroutine */ int xerbla_(char *, integer *);
 
 
@@ -16,12 +16,12 @@
     integer a_dim1, a_offset, c_dim1, c_offset, i__1, i__2, i__3;
 
     /* Local variables */
-    static integer info;
-    static doublereal temp;
-    static integer i, j, l;
+    integer info;
+    doublereal temp;
+    integer i, j, l;
     extern logical lsame_(const char *, const char *);
-    static integer nrowa;
-    static logical upper;
+    integer nrowa;
+    logical upper;
     extern /* Subroutine */ int xerbla_(char *, integer *);
 
 
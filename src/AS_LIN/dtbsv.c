@@ -15,13 +15,13 @@
     integer a_dim1, a_offset, i__1, i__2, i__3, i__4;
 
     /* Local variables */
-    static integer info;
-    static doublereal temp;
-    static integer i, j, l;
+    integer info;
+    doublereal temp;
+    integer i, j, l;
     extern logical lsame_(const char *, const char *);
-    static integer kplus1, ix, jx, kx;
+    integer kplus1, ix, jx, kx = 0;
     extern /* Subroutine */ int xerbla_(char *, integer *);
-    static logical nounit;
+    logical nounit;
 
 
 /*  Purpose
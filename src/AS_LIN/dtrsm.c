@@ -16,15 +16,15 @@
     integer a_dim1, a_offset, b_dim1, b_offset, i__1, i__2, i__3;
 
     /* Local variables */
-    static integer info;
-    static doublereal temp;
-    static integer i, j, k;
-    static logical lside;
+    integer info;
+    doublereal temp;
+    integer i, j, k;
+    logical lside;
     extern logical lsame_(const char *, const char *);
-    static integer nrowa;
-    static logical upper;
+    integer nrowa;
+    logical upper;
     extern /* Subroutine */ int xerbla_(char *, integer *);
-    static logical nounit;
+    logical nounit;
 
 
 /*  Purpose
@@ -116,12 +116,12 @@ integer ilaenv_(integer *ispec, const char *name, const char *opts, integer *n1,
        Subroutine */ int s_copy(char *, const char *, ftnlen, ftnlen);
     integer s_cmp(char *, char *, ftnlen, ftnlen);
     /* Local variables */
-    static integer i;
-    static logical cname, sname;
-    static integer nbmin;
-    static char c1[1], c2[2], c3[3], c4[2];
-    static integer ic, nb, iz, nx;
-    static char subnam[6];
+    integer i;
+    logical cname, sname;
+    integer nbmin;
+    char c1[1], c2[2], c3[3], c4[2];
+    integer ic, nb, iz, nx;
+    char subnam[6];
 
 
 
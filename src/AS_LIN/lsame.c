@@ -29,7 +29,7 @@ logical lsame_(const char *ca, const char *cb)
     /* System generated locals */
     logical ret_val;
     /* Local variables */
-    static integer inta, intb, zcode;
+    integer inta, intb, zcode;
 
 
     ret_val = *(unsigned char *)ca == *(unsigned char *)cb;
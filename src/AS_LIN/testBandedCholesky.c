@@ -0,0 +1,238 @@
+/**************************************************************************
+ * This file is part of Celera Assembler, a software program that
+ * assembles whole-genome shotgun reads into contigs and scaffolds.
+ * Copyright (C) 2010, J. Craig Venter Institute.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received (LICENSE.txt) a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *************************************************************************/
+
+// static const char *rcsid = "$Id$";
+
+//  Compares the blocked AS_LIN_bandedCholesky (built with
+//  -DAS_LIN_BLOCKED_CHOLESKY) against the f2c dpbtrf_()/dpbtrs_() on
+//  band systems shaped like the ones cgw builds in
+//  LeastSquaresGaps_CGW.C: every clone adds 1/variance to a dense
+//  triangle covering the run of gaps it spans, then one solve for the
+//  gap sizes and one solve per clone for the gap variances.
+//
+//  Reports time for both and the largest relative difference; exits
+//  non-zero if they disagree by more than rounding.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+
+#include "AS_LIN_bandedCholesky.h"
+
+extern int dpbtrf_(const char *, long *, long *, double *, long *, long *);
+extern int dpbtrs_(const char *, long *, long *, long *, double *, long *, double *, long *, long *);
+
+static
+double
+getTime(void) {
+  struct timeval  tp;
+  gettimeofday(&tp, NULL);
+  return(tp.tv_sec + (double)tp.tv_usec / 1000000.0);
+}
+
+typedef struct {
+  int      numGaps;
+  int      numClones;
+  int      kd;
+  int     *start;      //  first gap spanned
+  int     *end;        //  one past the last gap spanned
+  double  *mean;
+  double  *variance;
+} testSystem;
+
+static
+void
+makeSystem(testSystem *ts, int numGaps, int kd, int clonesPerGap) {
+  int  c;
+
+  ts->numGaps   = numGaps;
+  ts->numClones = numGaps * clonesPerGap;
+  ts->kd        = kd;
+  ts->start     = (int    *)malloc(sizeof(int)    * ts->numClones);
+  ts->end       = (int    *)malloc(sizeof(int)    * ts->numClones);
+  ts->mean      = (double *)malloc(sizeof(double) * ts->numClones);
+  ts->variance  = (double *)malloc(sizeof(double) * ts->numClones);
+
+  for (c=0; c<ts->numClones; c++) {
+    int  span = 1 + (c < numGaps ? 0 : random() % (kd + 1));
+
+    ts->start[c]    = (c < numGaps) ? c : random() % numGaps;
+    ts->end[c]      = ts->start[c] + span;
+
+    if (ts->end[c] > numGaps)
+      ts->end[c] = numGaps;
+
+    ts->mean[c]     = 1000.0 * (ts->end[c] - ts->start[c]) + (random() % 2001) - 1000.0;
+    ts->variance[c] = 1000.0 + random() % 100000;
+  }
+}
+
+static
+void
+freeSystem(testSystem *ts) {
+  free(ts->start);
+  free(ts->end);
+  free(ts->mean);
+  free(ts->variance);
+}
+
+static
+void
+fillSystem(testSystem *ts, double *ab, double *rhs) {
+  int  ldab = ts->kd + 1;
+  int  c, col, row;
+
+  memset(ab,  0, sizeof(double) * ts->numGaps * ldab);
+  memset(rhs, 0, sizeof(double) * ts->numGaps);
+
+  for (c=0; c<ts->numClones; c++)
+    for (col=ts->start[c]; col<ts->end[c]; col++) {
+      rhs[col] += ts->mean[c] / ts->variance[c];
+
+      for (row=col; row<ts->end[c]; row++)
+        ab[col * ldab + row - col] += 1.0 / ts->variance[c];
+    }
+}
+
+//  Returns the time; fills sol with the gap sizes and var with the gap variances.
+static
+double
+solveSystem(testSystem *ts, int useNew, double *ab, double *sol, double *var, double *spanned) {
+  long    N = ts->numGaps, KD = ts->kd, LDAB = ts->kd + 1, NRHS = 1, info = 0;
+  double  startTime;
+  int     c, g;
+
+  fillSystem(ts, ab, sol);
+
+  memset(var, 0, sizeof(double) * ts->numGaps);
+
+  startTime = getTime();
+
+  if (useNew) {
+    info = AS_LIN_bandedCholeskyFactor(ts->numGaps, ts->kd, ab, ts->kd + 1);
+    AS_LIN_bandedCholeskySolve(ts->numGaps, ts->kd, ab, ts->kd + 1, sol, 0);
+  } else {
+    dpbtrf_("L", &N, &KD, ab, &LDAB, &info);
+    dpbtrs_("L", &N, &KD, &NRHS, ab, &LDAB, sol, &N, &info);
+  }
+
+  if (info != 0)
+    fprintf(stderr, "factorization failed, info %ld\n", info), exit(1);
+
+  for (c=0; c<ts->numClones; c++) {
+    memset(spanned, 0, sizeof(double) * ts->numGaps);
+
+    for (g=ts->start[c]; g<ts->end[c]; g++)
+      spanned[g] = 1.0;
+
+    if (useNew)
+      AS_LIN_bandedCholeskySolve(ts->numGaps, ts->kd, ab, ts->kd + 1, spanned, ts->start[c]);
+    else
+      dpbtrs_("L", &N, &KD, &NRHS, ab, &LDAB, spanned, &N, &info);
+
+    for (g=0; g<ts->numGaps; g++)
+      var[g] += spanned[g] * spanned[g] / ts->variance[c];
+  }
+
+  return(getTime() - startTime);
+}
+
+static
+double
+relativeDifference(double *a, double *b, int n) {
+  double  maxDiff = 0.0;
+  int     i;
+
+  for (i=0; i<n; i++) {
+    double  scale = fabs(a[i]) > 1.0 ? fabs(a[i]) : 1.0;
+    double  diff  = fabs(a[i] - b[i]) / scale;
+
+    if (diff > maxDiff)
+      maxDiff = diff;
+  }
+
+  return(maxDiff);
+}
+
+
+int
+main(int argc, char **argv) {
+  int     sizes[]  = { 10, 100, 1000, 5000 };
+  int     bands[]  = { 1, 3, 8, 20, 50 };
+  int     failed   = 0;
+  int     si, bi;
+
+  srandom(1);
+
+  fprintf(stderr, "%6s %4s %8s  %10s %10s %7s  %9s %9s\n",
+          "gaps", "kd", "clones", "f2c", "new", "speedup", "gapDiff", "varDiff");
+
+  for (si=0; si<sizeof(sizes) / sizeof(int); si++)
+    for (bi=0; bi<sizeof(bands) / sizeof(int); bi++) {
+      testSystem  ts;
+      int         n  = sizes[si];
+      int         kd = bands[bi];
+
+      if (kd >= n)
+        continue;
+
+      makeSystem(&ts, n, kd, 4);
+
+      {
+        double *ab      = (double *)malloc(sizeof(double) * n * (kd + 1));
+        double *spanned = (double *)malloc(sizeof(double) * n);
+        double *solO    = (double *)malloc(sizeof(double) * n);
+        double *varO    = (double *)malloc(sizeof(double) * n);
+        double *solN    = (double *)malloc(sizeof(double) * n);
+        double *varN    = (double *)malloc(sizeof(double) * n);
+
+        double  timeO   = solveSystem(&ts, 0, ab, solO, varO, spanned);
+        double  timeN   = solveSystem(&ts, 1, ab, solN, varN, spanned);
+
+        double  gapDiff = relativeDifference(solO, solN, n);
+        double  varDiff = relativeDifference(varO, varN, n);
+
+        fprintf(stderr, "%6d %4d %8d  %10.6f %10.6f %7.2f  %9.2e %9.2e%s\n",
+                n, kd, ts.numClones,
+                timeO, timeN, (timeN > 0) ? timeO / timeN : 0.0,
+                gapDiff, varDiff,
+                ((gapDiff > 1e-8) || (varDiff > 1e-8)) ? "  FAILED" : "");
+
+        if ((gapDiff > 1e-8) || (varDiff > 1e-8))
+          failed++;
+
+        free(ab);
+        free(spanned);
+        free(solO);
+        free(varO);
+        free(solN);
+        free(varN);
+      }
+
+      freeSystem(&ts);
+    }
+
+  if (failed)
+    fprintf(stderr, "%d systems disagree.\n", failed);
+
+  return(failed ? 1 : 0);
+}
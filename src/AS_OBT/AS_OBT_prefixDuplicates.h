@@ -0,0 +1,70 @@
+
+/**************************************************************************
+ * This file is part of Celera Assembler, a software program that
+ * assembles whole-genome shotgun reads into contigs and scaffolds.
+ * Copyright (C) 2010, J. Craig Venter Institute.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received (LICENSE.txt) a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *************************************************************************/
+
+#ifndef AS_OBT_PREFIXDUPLICATES_H
+#define AS_OBT_PREFIXDUPLICATES_H
+
+// static const char *rcsid_AS_OBT_PREFIXDUPLICATES_H = "$Id$";
+
+#include "AS_global.h"
+#include "AS_PER_gkpStore.h"
+
+//  Finds reads that are an exact prefix of some other read, straight
+//  from the gkpStore; no overlaps are needed.
+//
+//  A 64-bit hash is built from the first AS_OBT_DEDUP_SPAN bases of
+//  each read, the hashes are sorted, and each clique of hash
+//  collisions is examined pairwise for exact prefixes.  The sort and
+//  the clique examination are spread over numThreads threads.
+//
+//  Of each prefix pair, the shorter read is the duplicate; of two
+//  identical reads, the one with the smaller iid.  A read that is
+//  already deleted is not reported again, but is still used to find
+//  its own prefixes.
+//
+//  Reads shorter than AS_OBT_DEDUP_SPAN are never examined.
+//
+#define AS_OBT_DEDUP_SPAN  48
+
+typedef struct {
+  AS_IID   iid;      //  this read is a prefix...
+  AS_IID   dupOf;    //  ...of this read
+} AS_OBT_prefixDuplicate;
+
+//  Decides if a read takes part, and if so, sets bgn,end to the region
+//  of the read to compare (the whole read on entry).  'fr' is loaded
+//  with GKFRAGMENT_SEQ.
+//
+typedef bool (*AS_OBT_prefixSelect)(gkFragment *fr, uint32 &bgn, uint32 &end, void *arg);
+
+//  Returns the number of duplicates found, and a new[] array of them
+//  in dups (NULL if none).  With sameLibrary set, reads are only
+//  compared against reads in the same library.
+//
+uint32
+AS_OBT_findPrefixDuplicates(gkStore                 *gkp,
+                            AS_OBT_prefixSelect      select,
+                            void                    *selectArg,
+                            bool                     sameLibrary,
+                            uint32                   numThreads,
+                            AS_OBT_prefixDuplicate *&dups);
+
+#endif
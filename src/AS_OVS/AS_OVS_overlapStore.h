@@ -49,7 +49,7 @@ typedef struct {
   uint32    numOlaps;  //  number of overlaps for this iid
 } OverlapStoreOffsetRecord;
 
-typedef struct {
+typedef struct OverlapStore_s {
   char                        storePath[FILENAME_MAX];
   int                         isOutput;
   char                        useBackup;
@@ -70,6 +70,17 @@ typedef struct {
 
   gkStore                    *gkp;
 
+  //  A layered store also returns the overlaps in its delta stores
+  //  (listed in 'dlt' in the store directory), merged in order with
+  //  its own, without rewriting anything.  layerOvl[] holds the next
+  //  overlap from each layer; layer 0 is this store.
+  //
+  uint32                      numDeltas;
+  struct OverlapStore_s     **deltas;
+  OVSoverlap                 *layerOvl;
+  char                       *layerValid;
+  int                         layerPrimed;
+
 #if 0
   uint16                     *fragClearBegin;
   uint16                     *fragClearEnd;
@@ -96,9 +107,19 @@ uint64             AS_OVS_numOverlapsInRange(OverlapStore *ovs);
 
 static
 uint32             AS_OVS_lastFragInStore(OverlapStore *ovs) {
-  return(ovs->ovs.largestIID);
+  uint32  last = ovs->ovs.largestIID;
+
+  for (uint32 d=0; d<ovs->numDeltas; d++)
+    if (last < ovs->deltas[d]->ovs.largestIID)
+      last = ovs->deltas[d]->ovs.largestIID;
+
+  return(last);
 }
 
+//  Add a delta store to a layered store.  The delta must not be
+//  layered itself.
+void               AS_OVS_addDeltaToOverlapStore(const char *name, const char *deltaName);
+
 
 //  The mostly private interface for creating an overlap store.
 
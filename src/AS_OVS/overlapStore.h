@@ -38,11 +38,20 @@ void
 buildStore(char *storeName, char *gkpName, uint64 memoryLimit, uint32 nThreads, uint32 doFilterOBT, uint32 fileListLen, char **fileList, Ovl_Skip_Type_t ovlSkipOpt);
 
 void
-mergeStore(char *storeName, char *mergeName);
+mergeStore(char *storeName, uint32 mergeLen, char **mergeNames);
+
+void
+addDeltaStore(char *storeName, char *deltaName);
 
 void
 updateErates(char *storeName, char *eratesName);
 
+void
+updateEratesInPlace(char *storeName, char *eratesName, uint32 nThreads);
+
+void
+rollbackErates(char *storeName, uint32 nThreads);
+
 void
 dumpStore(char *storeName, uint32 dumpBinary, double dumpERate, uint32 dumpType, uint32 bgnIID, uint32 endIID, uint32 qryIID);
 
@@ -59,6 +68,9 @@ OVSoverlap_sort(const void *a, const void *b);
 #define OP_DUMP           3
 #define OP_DUMP_PICTURE   4
 #define OP_UPDATE_ERATES  5
+#define OP_UPDATE_INPLACE 6
+#define OP_ROLLBACK       7
+#define OP_ADD_DELTA      8
 
 #define DUMP_5p         1
 #define DUMP_3p         2
@@ -164,9 +164,17 @@ sub merOverlapper($) {
     print F " -T ", getGlobal("obtMerThreshold"), " \\\n" if ($isTrim eq "trim");
     print F " -T ", getGlobal("ovlMerThreshold"), " \\\n" if ($isTrim ne "trim");
     print F " -t " . getGlobal("merOverlapperThreads") . "\\\n";
+    print F " -table $wrk/$outDir/seeds/\$jobid.posDB \\\n" if (getGlobal("merOverlapperSaveTables") == 1);
+    print F " -numa \\\n" if (getGlobal("merOverlapperNUMA") == 1);
     print F " -o $wrk/$outDir/seeds/\$jobid.ovm.WORKING.gz \\\n";
     print F "&& \\\n";
-    print F "mv $wrk/$outDir/seeds/\$jobid.ovm.WORKING.gz $wrk/$outDir/seeds/\$jobid.ovm.gz\n";
+    if (getGlobal("merOverlapperSaveTables") == 1) {
+        print F "mv $wrk/$outDir/seeds/\$jobid.ovm.WORKING.gz $wrk/$outDir/seeds/\$jobid.ovm.gz \\\n";
+        print F "&& \\\n";
+        print F "rm -f $wrk/$outDir/seeds/\$jobid.posDB $wrk/$outDir/seeds/\$jobid.posDB.info\n";
+    } else {
+        print F "mv $wrk/$outDir/seeds/\$jobid.ovm.WORKING.gz $wrk/$outDir/seeds/\$jobid.ovm.gz\n";
+    }
     close(F);
 
     system("chmod +x $wrk/$outDir/overmerry.sh");
@@ -113,6 +113,7 @@ sub merTrim {
             $cmd .= " -ovs $wrk/0-overlaptrim/$asm.obtStore \\\n";
             $cmd .= " -summary $wrk/0-overlaptrim/$asm.chimera.summary \\\n";
             $cmd .= " -report  $wrk/0-overlaptrim/$asm.chimera.report \\\n";
+            $cmd .= " -t " . getGlobal("obtThreads") . " \\\n";
             $cmd .= " -mininniepair 0 -minoverhanging 0 \\\n" if (getGlobal("doChimeraDetection") eq "aggressive");
             $cmd .= " > $wrk/0-overlaptrim/$asm.chimera.err 2>&1";
 
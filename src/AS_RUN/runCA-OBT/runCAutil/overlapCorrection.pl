@@ -15,6 +15,7 @@ sub overlapCorrection {
     if ((getGlobal("ovlOverlapper") eq "ovl") && (! -e "$wrk/3-overlapcorrection/frgcorr.sh")) {
         my $batchSize   = getGlobal("frgCorrBatchSize");
         my $numThreads  = getGlobal("frgCorrThreads");
+        my $memory      = getGlobal("frgCorrMemory");
         my $jobs        = int($numFrags / ($batchSize-1)) + 1;
 
         open(F, "> $wrk/3-overlapcorrection/frgcorr.sh") or caFailure("failed to write to '$wrk/3-overlapcorrection/frgcorr.sh'", undef);
@@ -55,6 +56,7 @@ sub overlapCorrection {
 
         print F "\$bin/correct-frags \\\n";
         print F "  -t $numThreads \\\n";
+        print F "  -M $memory \\\n" if ($memory > 0);
         print F "  -S $wrk/$asm.ovlStore \\\n";
         print F "  -o $wrk/3-overlapcorrection/\$jobid.frgcorr.WORKING \\\n";
         print F "  $wrk/$asm.gkpStore \\\n";
@@ -162,6 +164,7 @@ sub overlapCorrection {
 
     if (! -e "$wrk/3-overlapcorrection/ovlcorr.sh") {
         my $ovlCorrBatchSize  = getGlobal("ovlCorrBatchSize");
+        my $ovlCorrThreads    = getGlobal("ovlCorrThreads");
         my $jobs              = int($numFrags / ($ovlCorrBatchSize-1)) + 1;
 
         open(F, "> $wrk/3-overlapcorrection/ovlcorr.sh") or caFailure("failed to write '$wrk/3-overlapcorrection/ovlcorr.sh'", undef);
@@ -191,6 +194,7 @@ sub overlapCorrection {
 
         print F "if [ ! -e $wrk/3-overlapcorrection/\$jobid.erate ] ; then\n";
         print F "  \$bin/correct-olaps \\\n";
+        print F "    -t $ovlCorrThreads \\\n";
         print F "    -S $wrk/$asm.ovlStore \\\n";
         print F "    -e $wrk/3-overlapcorrection/\$jobid.erate.WORKING \\\n";
         print F "    $wrk/$asm.gkpStore \\\n";
@@ -275,7 +279,7 @@ sub overlapCorrection {
         }
 
         $cmd  = "$bin/overlapStore ";
-        $cmd .= " -u $wrk/$asm.ovlStore ";
+        $cmd .= " -U $wrk/$asm.ovlStore ";
         $cmd .= " $wrk/3-overlapcorrection/$asm.erates";
         $cmd .= "> $wrk/3-overlapcorrection/overlapStore-update-erates.err 2>&1";
         if (runCommand("$wrk/3-overlapcorrection", $cmd)) {
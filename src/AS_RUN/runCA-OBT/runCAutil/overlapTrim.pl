@@ -41,6 +41,7 @@ if (getGlobal("doMerBasedTrimming") == 0) {
         $cmd  = "$bin/initialTrim \\\n";
         $cmd .= " -log $wrk/0-overlaptrim/$asm.initialTrimLog \\\n";
         $cmd .= " -frg $wrk/$asm.gkpStore \\\n";
+        $cmd .= " -t " . getGlobal("obtThreads") . " \\\n";
         $cmd .= " >  $wrk/0-overlaptrim/$asm.initialTrim.report \\\n";
         $cmd .= " 2> $wrk/0-overlaptrim/$asm.initialTrim.err ";
 
@@ -53,6 +54,30 @@ if (getGlobal("doMerBasedTrimming") == 0) {
 
         unlink "0-overlaptrim/$asm.initialTrim.err";
     }
+
+    #  Remove exact prefix duplicates straight from the gkpStore, before
+    #  computing overlaps.  The overlap based dedup below still finds
+    #  mated and near-exact duplicates.
+    #
+    if ((getGlobal("doDeDuplication") != 0) &&
+        (! -e "$wrk/0-overlaptrim/$asm.prefixDedup.summary")) {
+        my $bin = getBinDirectory();
+        my $cmd;
+        $cmd  = "$bin/deduplicate \\\n";
+        $cmd .= "-gkp     $wrk/$asm.gkpStore \\\n";
+        $cmd .= "-prefix \\\n";
+        $cmd .= "-t       " . getGlobal("obtThreads") . " \\\n";
+        $cmd .= "-report  $wrk/0-overlaptrim/$asm.prefixDedup.report \\\n";
+        $cmd .= "-summary $wrk/0-overlaptrim/$asm.prefixDedup.summary \\\n";
+        $cmd .= "> $wrk/0-overlaptrim/$asm.prefixDedup.err 2>&1";
+
+        stopBefore("deDuplication", $cmd);
+
+        if (runCommand("$wrk/0-overlaptrim", $cmd)) {
+            unlink "$wrk/0-overlaptrim/$asm.prefixDedup.summary";
+            caFailure("failed to deduplicate the reads", "$wrk/0-overlaptrim/$asm.prefixDedup.err");
+        }
+    }
 }
 
     #  Compute overlaps, if we don't have them already
@@ -161,30 +186,11 @@ if (getGlobal("doMerBasedTrimming") == 0) {
         }
     }
 
-    #  Consolidate the overlaps, listing all overlaps for a single
-    #  fragment on a single line.  These are still iid's.
-
-    if ((! -e "$wrk/0-overlaptrim/$asm.ovl.consolidated") &&
-        (! -e "$wrk/0-overlaptrim/$asm.ovl.consolidated.bz2")) {
-
-        my $bin = getBinDirectory();
-        my $cmd;
-        $cmd  = "$bin/consolidate \\\n";
-        $cmd .= " -ovs $wrk/0-overlaptrim/$asm.obtStore \\\n";
-        $cmd .= " > $wrk/0-overlaptrim/$asm.ovl.consolidated \\\n";
-        $cmd .= "2> $wrk/0-overlaptrim/$asm.ovl.consolidated.err";
-
-        if (runCommand("$wrk/0-overlaptrim", $cmd)) {
-          unlink "$wrk/0-overlaptrim/$asm.ovl.consolidated";
-          caFailure("failed to consolidate overlaps", "$wrk/0-overlaptrim/$asm.ovl.consolidated.err");
-        }
-        unlink "$wrk/0-overlaptrim/$asm.ovl.consolidated.err";
-    }
-
-
-    #  We need to have all the overlaps squashed already, in particular so
-    #  that we can get the mode of the 5'mode.  We could do this all in
-    #  core, but that would take lots of space.
+    #  Consolidate the overlaps, summarizing all overlaps for a single
+    #  fragment, and decide on the trim points.  merge-trimming reads the
+    #  obtStore directly and keeps the (small) summaries in core; it needs
+    #  all of them to get the mode of the 5'mode.  The consolidate binary
+    #  still writes the same summaries as text, for debugging.
 
     if ((! -e "$wrk/0-overlaptrim/$asm.mergeLog") &&
         (! -e "$wrk/0-overlaptrim/$asm.mergeLog.bz2")) {
@@ -193,7 +199,8 @@ if (getGlobal("doMerBasedTrimming") == 0) {
         $cmd  = "$bin/merge-trimming \\\n";
         $cmd .= "-log $wrk/0-overlaptrim/$asm.mergeLog \\\n";
         $cmd .= "-frg $wrk/$asm.gkpStore \\\n";
-        $cmd .= "-ovl $wrk/0-overlaptrim/$asm.ovl.consolidated \\\n";
+        $cmd .= "-ovs $wrk/0-overlaptrim/$asm.obtStore \\\n";
+        $cmd .= "-t " . getGlobal("obtThreads") . " \\\n";
         $cmd .= "> $wrk/0-overlaptrim/$asm.merge.err 2>&1";
 
         stopBefore("mergeTrimming", $cmd);
@@ -216,6 +223,7 @@ if (getGlobal("doMerBasedTrimming") == 0) {
             $cmd .= " -ovs $wrk/0-overlaptrim/$asm.obtStore \\\n";
             $cmd .= " -summary $wrk/0-overlaptrim/$asm.chimera.summary \\\n";
             $cmd .= " -report  $wrk/0-overlaptrim/$asm.chimera.report \\\n";
+            $cmd .= " -t " . getGlobal("obtThreads") . " \\\n";
             $cmd .= " -mininniepair 0 -minoverhanging 0 \\\n" if (getGlobal("doChimeraDetection") eq "aggressive");
             $cmd .= " > $wrk/0-overlaptrim/$asm.chimera.err 2>&1";
 
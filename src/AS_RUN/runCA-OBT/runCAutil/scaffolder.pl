@@ -83,6 +83,7 @@ sub CGW ($$$$$$) {
     $cmd .= "  -B $B \\\n";
     $cmd .= "  -u $wrk/4-unitigger/$asm.unused.ovl \\\n" if (getGlobal("cgwUseUnitigOverlaps") != 0);
     $cmd .= "  -m $sampleSize \\\n";
+    $cmd .= "  -T " . getGlobal("cgwThreads") . " \\\n";
     $cmd .= "  -g $wrk/$asm.gkpStore \\\n";
     $cmd .= "  -t $tigStore \\\n";
     $cmd .= "  -o $wrk/$thisDir/$asm \\\n";
@@ -152,7 +153,7 @@ sub eCR ($$$) {
         $cmd .= " -t $wrk/$asm.tigStore ";
         $cmd .= " -n $lastckp ";
         $cmd .= " -c $asm ";
-        $cmd .= " -N 4 ";
+        $cmd .= " -N " . ((getGlobal("cgwThreads") > 1) ? 1 : 4) . " ";
         $cmd .= " -p $wrk/$thisDir/extendClearRanges.partitionInfo";
         $cmd .= "  > $wrk/$thisDir/extendClearRanges.partitionInfo.err 2>&1";
 
@@ -202,6 +203,7 @@ sub eCR ($$$) {
                 print F " -c $asm \\\n";
                 print F " -b $curScaffold -e $endScaffold \\\n";
                 print F " -i $iter \\\n";
+                print F " -T " . getGlobal("cgwThreads") . " \\\n";
                 print F " > $j.err 2>&1\n";
                 close(F);
 
@@ -41,6 +41,32 @@ sub unitigger () {
 
         if ($unitigger eq "bog") {
             my $bmd = getGlobal("bogBadMateDepth");
+            my $rmt = getGlobal("bogRepeatMerThreshold");
+
+            #  Flag repeat reads from the meryl counts made for the overlapper.
+            #
+            if (defined($rmt) && (! -e "$wrk/4-unitigger/$asm.markRepeatReads.success")) {
+                my $merSize = getGlobal("ovlMerSize");
+                my $merComp = (getGlobal("ovlOverlapper") eq "mer") ? getGlobal("merCompression") : 0;
+                my $merCnts = "$wrk/0-mercounts/$asm-C-ms$merSize-cm$merComp";
+
+                caFailure("bogRepeatMerThreshold needs meryl counts in '$merCnts'", undef) if (! -e "$merCnts.mcdat");
+
+                my $mcmd;
+                $mcmd  = "$bin/markRepeatReads ";
+                $mcmd .= " -g  $wrk/$asm.gkpStore ";
+                $mcmd .= " -m  $merSize ";
+                $mcmd .= " -c  $merComp ";
+                $mcmd .= " -mc $merCnts ";
+                $mcmd .= " -n  $rmt ";
+                $mcmd .= " > $wrk/4-unitigger/$asm.markRepeatReads.err 2>&1";
+
+                if (runCommand("$wrk/4-unitigger", $mcmd)) {
+                    caFailure("failed to mark repeat reads", "$wrk/4-unitigger/$asm.markRepeatReads.err");
+                }
+
+                touch("$wrk/4-unitigger/$asm.markRepeatReads.success");
+            }
 
             $cmd  = "$bin/buildUnitigs ";
             $cmd .= " -O $wrk/$asm.ovlStore ";
@@ -53,6 +79,8 @@ sub unitigger () {
             $cmd .= " -b "      if (getGlobal("bogBreakAtIntersections") == 1);
             $cmd .= " -m $bmd " if (defined($bmd));
             $cmd .= " -U "      if ($u == 1);
+            $cmd .= " -R "      if (defined($rmt));
+            $cmd .= " -t " . getGlobal("bogThreads");
             $cmd .= " -o $wrk/4-unitigger/$asm ";
             $cmd .= " > $wrk/4-unitigger/unitigger.err 2>&1";
         } elsif ($unitigger eq "utg") {
@@ -65,6 +93,7 @@ sub unitigger () {
             $cmd .= " -k " if (getGlobal("utgRecalibrateGAR") == 1);
             $cmd .= " -l $l " if defined($l);
             $cmd .= " -d 1 -x 1 -z 10 -j 5 -U $u ";
+            $cmd .= " -t " . getGlobal("utgThreads");
             $cmd .= " -o $wrk/4-unitigger/$asm ";
             $cmd .= " > $wrk/4-unitigger/unitigger.err 2>&1";
         } else {
@@ -298,6 +298,9 @@ sub setDefaults () {
     $global{"doChimeraDetection"}          = "normal";
     $synops{"doChimeraDetection"}          = "Enable the OBT chimera detection and cleaning module; 'off', 'normal' or 'aggressive'";
 
+    $global{"obtThreads"}                  = 1;
+    $synops{"obtThreads"}                  = "Number of threads to use for OBT overlap consolidation and chimera detection";
+
     #####  Mer Based Trimming
 
     $global{"doMerBasedTrimming"}          = 0;
@@ -356,6 +359,12 @@ sub setDefaults () {
     $global{"merOverlapperExtendBatchSize"}= 75000;
     $synops{"merOverlapperExtendBatchSize"}= "Number of fragments in a mer overlapper seed extension batch; directly affects memory usage";
 
+    $global{"merOverlapperSaveTables"}     = 0;
+    $synops{"merOverlapperSaveTables"}     = "Save each mer overlapper seed finding hash table until the job finishes; only speeds up rerunning a failed job";
+
+    $global{"merOverlapperNUMA"}           = 0;
+    $synops{"merOverlapperNUMA"}           = "Interleave the mer overlapper hash table over NUMA nodes and pin threads to CPUs (Linux)";
+
     $global{"merOverlapperCorrelatedDiffs"}= 0;
     $synops{"merOverlapperCorrelatedDiffs"}= "EXPERIMENTAL!";
 
@@ -393,12 +402,18 @@ sub setDefaults () {
     $global{"frgCorrThreads"}              = 2;
     $synops{"frgCorrThreads"}              = "Number of threads to use while computing fragment errors";
 
+    $global{"frgCorrMemory"}               = 0;
+    $synops{"frgCorrMemory"}               = "MB of fragments and overlaps to hold per fragment error detection batch; 0 loads the whole batch at once";
+
     $global{"frgCorrConcurrency"}          = 1;
     $synops{"frgCorrConcurrency"}          = "If not SGE, number of fragment error detection processes to run at the same time";
 
     $global{"ovlCorrBatchSize"}            = 200000;
     $synops{"ovlCorrBatchSize"}            = "Number of fragments per overlap error correction batch";
 
+    $global{"ovlCorrThreads"}              = 2;
+    $synops{"ovlCorrThreads"}              = "Number of threads to use while recomputing overlap errors";
+
     $global{"ovlCorrConcurrency"}          = 4;
     $synops{"ovlCorrConcurrency"}          = "If not SGE, number of overlap error correction processes to run at the same time";
 
@@ -422,6 +437,15 @@ sub setDefaults () {
     $global{"bogBadMateDepth"}             = 7;
     $synops{"bogBadMateDepth"}             = "EXPERT!";
 
+    $global{"bogThreads"}                  = 1;
+    $synops{"bogThreads"}                  = "Number of threads to use for bog bubble popping, mate checking and output";
+
+    $global{"bogRepeatMerThreshold"}       = undef;
+    $synops{"bogRepeatMerThreshold"}       = "Flag reads made mostly of mers seen at least this many times as repeats; bog ignores their overlaps.  Needs the meryl counts, so not allowed when both overlappers are ovl and doMerBasedTrimming=0 (jellyfish counts)";
+
+    $global{"utgThreads"}                  = 1;
+    $synops{"utgThreads"}                  = "Number of threads to use for utg overlap loading and edge sorting";
+
     #####  Scaffolder Options
 
     $global{"cgwPurgeCheckpoints"}         = 1;
@@ -448,6 +472,9 @@ sub setDefaults () {
     $global{"cgwDistanceSampleSize"}       = 100;
     $synops{"cgwDistanceSampleSize"}       = "Require N mates to reestimate insert sizes";
 
+    $global{"cgwThreads"}                  = 1;
+    $synops{"cgwThreads"}                  = "Number of threads to use in the scaffolder";
+
     $global{"doResolveSurrogates"}         = 1;
     $synops{"doResolveSurrogates"}         = "Place fragments in surrogates in the final assembly";
 
@@ -689,6 +716,10 @@ sub setParameters () {
     if (defined(getGlobal("unitigger")) && (getGlobal("unitigger") ne "utg") && (getGlobal("unitigger") ne "bog")) {
         caFailure("invalid unitigger specified (" . getGlobal("unitigger") . "); must be 'utg' or 'bog'", undef);
     }
+    if (defined(getGlobal("bogRepeatMerThreshold")) &&
+        (getGlobal("ovlOverlapper") eq "ovl") && (getGlobal("obtOverlapper") eq "ovl") && (!getGlobal("doMerBasedTrimming"))) {
+        caFailure("bogRepeatMerThreshold needs meryl mer counts; with ovlOverlapper=ovl, obtOverlapper=ovl and no doMerBasedTrimming, mers are counted with jellyfish instead", undef);
+    }
     if ((getGlobal("vectorTrimmer") ne "ca") && (getGlobal("vectorTrimmer") ne "figaro")) {
         caFailure("invalid vectorTrimmer specified (" . getGlobal("vectorTrimmer") . "); must be 'ca' or 'figaro'", undef);
     }
@@ -0,0 +1,89 @@
+
+/**************************************************************************
+ * This file is part of Celera Assembler, a software program that
+ * assembles whole-genome shotgun reads into contigs and scaffolds.
+ * Copyright (C) 1999-2004, Applera Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received (LICENSE.txt) a copy of the GNU General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *************************************************************************/
+
+#ifndef AS_UTL_COVERAGESTAT_H
+#define AS_UTL_COVERAGESTAT_H
+
+#include "AS_global.h"
+
+//  Gene Myers' coverage discriminator statistic, the A-stat, and the estimate of the global
+//  fragment arrival rate it is computed against.  The formula and the big-unitig recalibration
+//  were copied between CGB, BOG and CGW; they live here now.  Each caller still collects its own
+//  per-unitig rho and fragment counts.
+//
+//  Rho is the number of bases in the unitig between the first fragment arrival and the last
+//  fragment arrival.  It is the sum of the fragment overhangs in the unitig. For intuitive
+//  purposes you can think of it as the length of the unitig minus the length of the last
+//  fragment. Thus a singleton unitig has a rho equal to zero.
+//
+//  A singleton unitig provides no information as to its local fragment arrival rate. We need at
+//  least two closely spaced fragments that are randomly sampled from the unitig to get a local
+//  estimate of the fragment arrival rate.
+//
+//  The local arrival rate of fragments in the unitig is:
+//
+//    arrival_rate_local = ((float)(nfrag_randomly_sampled_in_unitig-1))/(float)rho
+//
+//  The formula for the coverage discriminator statistic for the unitig is:
+//
+//    (arrival_rate_global/arrival_rate_local - ln(2))*(nfrag_randomly_sampled_in_unitig-1)
+//
+//  The division by zero singularity cancels out to give the formula:
+//
+//    (arrival_rate_global*rho - ln(2)*(nfrag_randomly_sampled_in_unitig-1)
+//
+//  Call fragments that are not randomly sampled in the genome as "guide" fragments.  Guides are
+//  not randomly spaced fragments in the genome, and should not contribute to the fragment count.
+//
+//  The coverage discriminator statistic should be positive for single coverage, negative for
+//  multiple coverage, and near zero for indecisive.
+//
+float
+AS_UTL_coverageStatistic(double rho,
+                         int32  numRandomFrags,
+                         float  globalArrivalRate);
+
+inline
+float
+AS_UTL_localArrivalRate(double rho, int32 numRandomFrags) {
+  return((rho > 0) ? ((float)(MAX(numRandomFrags, 1) - 1)) / ((float)rho) : 0.0f);
+}
+
+
+//  Recalibrate the global arrival rate to the largest local arrival rate that still looks
+//  unique.  Each unitig contributes AS_UTL_numArrivalRateSamples(rho) copies of its local arrival
+//  rate to samples; nothing is done unless the samples cover half of totalRho.  The samples are
+//  sorted in place, so the caller can report the distribution.  Returns the recalibrated rate,
+//  or globalArrivalRate if there are too few samples.
+//
+inline
+size_t
+AS_UTL_numArrivalRateSamples(double rho) {
+  return((rho > 10000) ? (size_t)rho / 10000 : 0);
+}
+
+float
+AS_UTL_recalibrateArrivalRate(float   globalArrivalRate,
+                              double  totalRho,
+                              float  *samples,
+                              size_t  samplesLen);
+
+#endif